@@ -0,0 +1,128 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Block Sorting Engine
+//  computes the BWT of many independent blocks (bzip2/BSC style)
+//  on a shared thread pool
+
+#ifndef SORT_BATCH_H
+#define SORT_BATCH_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "detail/suffix.h"
+#include "detail/thread.h"
+#include "inplace.h"
+#include "pages.h"
+#include "suffix.h"
+
+namespace sort {
+namespace batch {
+
+// A single block: [in, in + size) is transformed into [out, out + size)
+// The sentinel row is left out of the output, primary is its row
+// (the row of the original string, as returned by libdivsufsort's divbwt)
+struct block {
+  const unsigned char* in;
+  unsigned char* out;
+  std::size_t size;
+  std::size_t primary;
+};
+
+// T is the index type used for SA and ISA, every block must be
+// smaller than its maximum value
+template <class T = std::int32_t> class engine {
+ public:
+  // threads = 0 uses one thread per hardware thread
+  explicit engine(unsigned threads = 0) : pool_(threads), scratch_(pool_.size()) {}
+
+  // Transform all blocks in [first, last)
+  // Large blocks are scheduled first to keep every thread busy until the end
+  // and each thread reuses its own SA, ISA and scratch buffers across blocks
+  template <class B> void bwt(B first, B last) {
+    std::vector<std::size_t> order(std::distance(first, last));
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    sort::inplace::quick(order.begin(), order.end(), [first](std::size_t i) {
+      return ~first[i].size;  // largest first
+    });
+
+    pool_.run(order.size(), [this, first, &order](unsigned w, std::size_t j) {
+      transform(scratch_[w], first[order[j]]);
+    });
+  }
+
+  template <class B> void bwt(B& blocks) { bwt(std::begin(blocks), std::end(blocks)); }
+
+  unsigned threads() const { return pool_.size(); }
+
+ private:
+  struct buffers {
+    memory::buffer<T> SA, ISA, A;
+  };
+
+  static void transform(buffers& buf, block& b) {
+    auto n = static_cast<std::ptrdiff_t>(b.size);
+    if (n == 0) return (void) (b.primary = 0);
+
+    // Buffers only ever grow so big blocks pay for the allocation once
+    // (huge pages where available, see pages.h)
+    if (buf.SA.size() < static_cast<std::size_t>(n + 1)) {
+      buf.SA = memory::buffer<T>(n + 1);
+      buf.ISA = memory::buffer<T>(n + 1);
+#ifdef USE_COPY
+      buf.A = memory::buffer<T>(n + 1);
+#endif
+    }
+    auto SAf = buf.SA.begin(), SAl = SAf + (n + 1);
+    auto ISAf = buf.ISA.begin();
+
+    detail::suffix::bucket(b.in, b.in + n, SAf, ISAf);
+#ifdef USE_COPY
+    sort::suffix::daware(SAf, SAl, ISAf, buf.A.begin(), buf.A.begin() + (n + 1));
+#else
+    sort::suffix::daware(SAf, SAl, ISAf);
+#endif
+
+    // Row 0 is the sentinel suffix, its BWT character is the last byte
+    auto out = b.out;
+    for (auto it = SAf; it != SAl; ++it) {
+      if (*it == 0)
+        b.primary = static_cast<std::size_t>(it - SAf);
+      else
+        *out++ = b.in[*it - 1];
+    }
+  }
+
+  detail::thread::pool pool_;
+  std::vector<buffers> scratch_;
+};
+
+}  // batch
+}  // sort
+
+#endif  // SORT_BATCH_H
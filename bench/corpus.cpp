@@ -0,0 +1,58 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Corpus benchmark
+//  times suffix::build on the given files (e.g. the gauntlet, LTCB or
+//  manzini's corpus from the tables below) with 32 bit SA and ISA and
+//  n / 4 scratch
+//
+//  g++ -O2 -std=c++14 -I.. corpus.cpp -o corpus && ./corpus files...
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "../suffix.h"
+
+int main(int argc, char **argv) {
+  std::printf("| File            |    Size    |    build    |\n");
+  std::printf("|-----------------|-----------:|------------:|\n");
+  double sum = 0; std::size_t total = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream in(argv[i], std::ios::binary);
+    if (!in) { std::fprintf(stderr, "can't open %s\n", argv[i]); return 1; }
+    std::vector<unsigned char> text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<std::int32_t> SA(text.size() + 1), ISA(text.size() + 1);
+    std::vector<sort::pair<std::int32_t, std::int32_t>> A(text.size() / 4 + 1);
+    auto start = std::chrono::steady_clock::now();
+    sort::suffix::build(text.begin(), text.end(), 256, SA.begin(), ISA.begin(), A.begin(), A.end());
+    auto end = std::chrono::steady_clock::now();
+
+    double s = std::chrono::duration<double>(end - start).count();
+    std::printf("| %-15.15s | %10zu | %11.5f |\n", argv[i], text.size(), s);
+    sum += s; total += text.size();
+  }
+  std::printf("| %-15s | %10zu | %11.5f |\n", "sum", total, sum);
+}
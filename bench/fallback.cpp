@@ -0,0 +1,87 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Worst case fallback benchmark
+//  sorts positions by keys stored elsewhere (like ISA lookups of daware)
+//  with the introsort budget exhausted from the start so everything runs
+//  through detail::inplace::fallback
+//
+//  g++ -O2 -std=c++14 -I.. fallback.cpp -o fallback && ./fallback [n]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../inplace.h"
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 20000000;
+  std::mt19937_64 rng(5);
+  std::vector<std::uint32_t> key(n);
+  for (auto &k : key) k = static_cast<std::uint32_t>(rng() % (n / 4 + 1));
+  std::vector<int> order(n);
+  for (int i = 0; i < n; ++i) order[i] = i;
+  std::shuffle(order.begin(), order.end(), rng);
+
+  auto index = [&key](int i) { return key[i]; };
+  auto nocb = [](auto a, auto b) { (void) a; (void) b; };
+
+  auto run = [&](const char *name, auto sort) {
+    auto a = order;
+    auto start = std::chrono::steady_clock::now();
+    sort(a);
+    auto end = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 1; i < n; ++i) ok &= index(a[i - 1]) <= index(a[i]);
+    std::printf("%-28s %8.0f ms %s\n", name, std::chrono::duration<double, std::milli>(end - start).count(),
+                ok ? "" : "FAILED");
+    return ok;
+  };
+
+  bool ok = true;
+  ok &= run("std::sort", [&](std::vector<int> &a) {
+    std::sort(a.begin(), a.end(), sort::detail::misc::compare(index));
+  });
+  ok &= run("quick", [&](std::vector<int> &a) {
+    sort::inplace::quick(a.begin(), a.end(), index);
+  });
+  ok &= run("std::make_heap/sort_heap", [&](std::vector<int> &a) {
+    std::make_heap(a.begin(), a.end(), sort::detail::misc::compare(index));
+    std::sort_heap(a.begin(), a.end(), sort::detail::misc::compare(index));
+  });
+  ok &= run("fallback heap", [&](std::vector<int> &a) {
+    sort::detail::inplace::quick<sort::detail::misc::NOCB, 0>(a.begin(), a.end(), index, nocb, 0);
+  });
+  for (int d : {1, 8, 64}) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "fallback merge (n/%d pairs)", d);
+    ok &= run(name, [&](std::vector<int> &a) {
+      std::vector<sort::detail::misc::pair<std::uint32_t, int>> S(n / d);
+      sort::detail::inplace::quick<sort::detail::misc::NOCB, 0>(a.begin(), a.end(), index, nocb, 0,
+                                                                S.data(), S.data() + S.size());
+    });
+  }
+  return ok ? 0 : 1;
+}
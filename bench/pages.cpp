@@ -0,0 +1,64 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Huge page benchmark
+//  times suffix::build with SA, ISA and scratch in memory::buffer of
+//  normal pages against huge pages where the system provides them (see
+//  pages.h) on the given file or a generated DNA like text of n symbols
+//
+//  g++ -O2 -std=c++14 -I.. pages.cpp -o pages && ./pages [file | n]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "../pages.h"
+#include "../suffix.h"
+
+int main(int argc, char **argv) {
+  std::vector<unsigned char> text;
+  std::ifstream in(argc > 1 ? argv[1] : "", std::ios::binary);
+  if (in) {
+    text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  } else {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 26;
+    std::mt19937_64 rng(5);
+    text.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+      text[i] = i >= 1000 && rng() % 8 ? text[i - 1000 + rng() % 3] : "ACGT"[rng() % 4];
+  }
+  auto n = text.size();
+
+  for (bool huge : {false, true}) {
+    sort::memory::buffer<std::int32_t> SA(n + 1, huge), ISA(n + 1, huge), A(n + 1, huge);
+    auto start = std::chrono::steady_clock::now();
+    sort::suffix::build(text.begin(), text.end(), 256, SA.begin(), ISA.begin(), A.begin(), A.end());
+    auto end = std::chrono::steady_clock::now();
+    std::printf("%-24s %10zu %8.0f ms\n", sort::memory::name(SA.backing()), n,
+                std::chrono::duration<double, std::milli>(end - start).count());
+  }
+}
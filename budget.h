@@ -0,0 +1,137 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Memory Budget Planner
+//  picks index width, copy or in-place sorting and the scratch size
+//  of a suffix array construction for a given byte limit
+
+#ifndef SORT_BUDGET_H
+#define SORT_BUDGET_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "detail/misc.h"
+#include "suffix.h"
+
+namespace sort {
+namespace budget {
+
+// What build() will allocate for a text of n symbols
+// The text itself is owned by the caller and not part of the budget
+struct plan {
+  std::size_t width   = 0;  // Bytes per SA / ISA element (4 or 8), 0 if nothing fits
+  std::size_t scratch = 0;  // Elements of scratch space, 0 sorts in-place
+  std::size_t peak    = 0;  // Predicted peak bytes (SA + ISA + scratch + grouping)
+                            // or the minimum needed if it doesn't fit
+
+  bool fits() const { return width != 0; }
+  bool copy() const { return scratch != 0; }
+};
+
+// Bytes of the counters of the initial grouping (see detail::suffix::group)
+inline std::size_t grouping(std::size_t n, std::size_t sigma) {
+  if (sigma <= std::max<std::size_t>(detail::misc::BUCKET_MAX, n / 4))
+    return 2 * (sigma + 1) * sizeof(std::ptrdiff_t);  // counts + write positions
+  return (std::size_t(1) << detail::misc::RADIX_BITS) * sizeof(std::ptrdiff_t);
+}
+
+// Bytes of one set of samplesort distribution buffers, used by the
+// chunked copy mode which sorts groups bigger than the scratch space (see
+// detail::copy::chunked) and for copies of at least SAMPLE_COPY_MIN
+inline std::size_t chunking() {
+  return (2 * detail::misc::SAMPLE_BUCKETS + 2) * detail::misc::SAMPLE_BLOCK
+    + (12 * detail::misc::SAMPLE_BUCKETS + 3) * sizeof(std::ptrdiff_t)
+    + 2 * detail::misc::SAMPLE_BUCKETS * sizeof(std::int64_t);
+}
+
+// Bytes of the buffers needed with s elements of scratch space
+inline std::size_t chunking(std::size_t n, std::size_t s) {
+  return (s != 0 && s < n + 1 ? chunking() : 0)
+    + (s > 2 * static_cast<std::size_t>(detail::misc::SAMPLE_COPY_MIN) ? chunking() : 0);
+}
+
+// Plan a build() of n symbols in [0, sigma) within limit bytes
+// 32 bit indices are used whenever n + 1 fits them. Scratch space is worth
+// it once it holds a group of COPY_MIN pairs and never needs more than
+// n + 1 elements (the size every other caller passes). Everything left of
+// the limit up to that goes into scratch, otherwise daware sorts in-place.
+// Less than n + 1 elements sort the biggest groups in chunks which adds
+// the buffers of a distribution step, so does scratch big enough for
+// copies of SAMPLE_COPY_MIN elements.
+// The recursion free sorts only add O(log n) stack on top and their worst
+// case fallback works within the scratch space (or none at all).
+inline plan make(std::size_t n, std::size_t limit, std::size_t sigma = 256) {
+  plan p;
+  p.width = n + 1 <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())
+    ? sizeof(std::int32_t) : sizeof(std::int64_t);
+
+  auto base = 2 * (n + 1) * p.width + grouping(n, sigma);
+  if (limit < base) {
+    plan q; q.peak = base;
+    return q;
+  }
+
+#ifdef USE_COPY
+  // A pair of key and value takes two elements
+  // The buffers depend on the scratch size, shrinking it twice settles them
+  auto room = std::min((limit - base) / p.width, n + 1);
+  for (int i = 0; i < 2; ++i) {
+    auto extra = chunking(n, room);
+    room = limit - base > extra ? std::min((limit - base - extra) / p.width, n + 1) : 0;
+  }
+  if (room >= 2 * static_cast<std::size_t>(detail::misc::COPY_MIN)
+      && base + room * p.width + chunking(n, room) <= limit)
+    p.scratch = room;
+#endif
+  p.peak = base + p.scratch * p.width + chunking(n, p.scratch);
+  return p;
+}
+
+// Suffix array of [Tf, Tl) following the plan p (see sort::suffix::build)
+// SA and ISA need room for n + 1 elements of p.width bytes
+// Returns false without touching anything if the plan doesn't fit them
+template <class S, class T, class U>
+bool build(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf, const plan& p) {
+  using X = std::remove_reference_t<decltype(*ISAf)>;
+  if (!p.fits() || sizeof(X) != p.width) return false;
+
+#ifdef USE_COPY
+  std::vector<X> A(p.scratch);
+  sort::suffix::build(Tf, Tl, sigma, SAf, ISAf, A.begin(), A.end());
+#else
+  sort::suffix::build(Tf, Tl, sigma, SAf, ISAf);
+#endif
+  return true;
+}
+
+}  // budget
+}  // sort
+
+#endif  // SORT_BUDGET_H
@@ -28,11 +28,15 @@
 #include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include "detail/misc.h"
+#include "detail/sample.h"
 #include "inplace.h"
 
 namespace sort {
@@ -41,13 +45,95 @@ namespace sort {
 template<class T1, class T2>
 using pair = detail::misc::pair<T1, T2>;
 
+namespace detail {
 namespace copy {
 
-// Oportunistic version of the quicksort
-// Uses free space given to it to copy together key and value
-// then sorting it
-template <int LR = detail::misc::LR, class T, class U, class I, class C>
-inline void quick(T first, T last, U Sf, U Sl, I index, C cb) {
+// Samplesort buffers for elements W with keys V (chunked mode) and their
+// pairs, kept for a whole sort (e.g. every group of daware) and only
+// allocated once a group needs them
+template <class W, class V>
+using cache = detail::sample::cache<detail::sample::buffers<W, V>,
+                                    detail::sample::buffers<detail::misc::pair<V, W>, V>>;
+constexpr const std::size_t ELEMENTS = 0, PAIRS = 1;
+
+// Sort the copies [first, last) in the scratch space with block
+// quicksort or with the samplesort (buffers K of cache) once they are
+// too big for the cache and a distribution step pays off
+template <int LR, std::size_t K, class T, class I, class C, class S>
+inline void copies(T first, T last, I index, C cb, S &cache) {
+  auto n = std::distance(first, last);
+  if (n < detail::misc::SAMPLE_COPY_MIN)
+    return sort::inplace::block<LR>(first, last, index, cb);
+  detail::sample::sort<LR, 1>(first, last, index, cb, cache.template get<K>(), detail::misc::ilogb(n + 1));
+}
+
+// In-place quicksort of [first, last) whose worst case fallback merges in
+// the scratch space [Sf, Sl) (see detail::inplace::fallback)
+template <int LR, class T, class U, class I, class C>
+inline void inplace(T first, T last, U Sf, U Sl, I index, C cb) {
+  int budget = 3 * detail::misc::ilogb(last - first + 1) >> 1;
+  detail::inplace::quick<LR, 0>(first, last, index, cb, budget, Sf, Sl);
+}
+
+// Sort [first, last) which doesn't fit the scratch space: a distribution
+// step of the in-place samplesort (see detail::sample) splits it into
+// buckets until they fit, fit(bf, bl) sorts each in the scratch space and
+// equality buckets are finished right away. Buckets are handled in the
+// order of the callbacks. Ranges too small for a distribution step (or
+// when the budget ran out) are sorted in-place.
+template <int LR, class T, class U, class I, class C, class F, class B>
+inline void chunked(T first, T last, U Sf, U Sl, I index, C cb, F fit, B &buf, int budget) {
+  using W = typename std::iterator_traits<T>::value_type;
+  auto n = std::distance(first, last);
+
+  int log;
+  if (n < detail::sample::minimum<W>() || budget-- == 0
+      || (log = detail::sample::splitters(first, last, index, buf)) == 0)
+    return detail::copy::inplace<LR>(first, last, Sf, Sl, index, cb);
+
+  detail::sample::distribute(first, last, index, buf, log);
+
+  // Buckets are overwritten by the recursion so keep the boundaries
+  auto nb = std::ptrdiff_t(2) << log;
+  auto d = buf.push(nb + 1);
+
+  auto recurse = [&](std::ptrdiff_t b) {
+    auto bf = first + buf.bounds[d + b], bl = first + buf.bounds[d + b + 1];
+    if (bf == bl) return;
+    if (b & 1) {
+      // Equality bucket - all keys equal the splitter
+      if (LR != detail::misc::NOCB) cb(bf, bl);
+    } else if (bl - bf < std::distance(Sf, Sl)) {
+      fit(bf, bl);
+    } else {
+      detail::copy::chunked<LR>(bf, bl, Sf, Sl, index, cb, fit, buf, budget);
+    }
+  };
+
+  if (LR) for (std::ptrdiff_t b = 0; b < nb; ++b) recurse(b);
+  else for (std::ptrdiff_t b = nb; b-- > 0;) recurse(b);
+  buf.pop(d);
+}
+
+// Entry to the chunked mode if [first, last) is big enough to be worth
+// a distribution step and the scratch space [Sf, Sl) holds a group
+// returns false if not (the caller sorts in-place)
+template <int LR, class T, class U, class I, class C, class F, class K>
+inline bool chunked(T first, T last, U Sf, U Sl, I index, C cb, F fit, K &cache) {
+  using W = typename std::iterator_traits<T>::value_type;
+  if (std::distance(Sf, Sl) < detail::misc::COPY_MIN || std::distance(first, last) < detail::sample::minimum<W>())
+    return false;
+
+  auto &buf = cache.template get<ELEMENTS>();
+  int budget = detail::misc::ilogb(std::distance(first, last) + 1);
+  detail::copy::chunked<LR>(first, last, Sf, Sl, index, cb, fit, buf, budget);
+  return true;
+}
+
+// Copy quicksort of [first, last) with the chunked mode buffers taken
+// from cache (see sort::copy::quick)
+template <int LR, class T, class U, class I, class C, class K>
+inline void quick(T first, T last, U Sf, U Sl, I index, C cb, K &cache) {
   using typeA = std::remove_reference_t<decltype(*Sf)>;
   using typeB = std::remove_reference_t<decltype(*first)>;
   using typeC = std::remove_reference_t<decltype(index(*first))>;
@@ -61,7 +147,7 @@ inline void quick(T first, T last, U Sf, U Sl, I index, C cb) {
     typeC pivot; int equals;
     std::tie(pivot, equals) = detail::misc::median7_copy<typeC>(first, index);
     if (std::distance(first, last) * (6 - equals) < detail::misc::COPY_MIN * 7)
-      return sort::inplace::quick<LR>(first, last, index, cb);
+      return detail::copy::inplace<LR>(first, last, Sf, Sl, index, cb);
 
     // copy together + initial partitioning
     auto a = Sf, b = Sl;
@@ -81,18 +167,21 @@ inline void quick(T first, T last, U Sf, U Sl, I index, C cb) {
     };
 
     if (LR) {
-      sort::inplace::block<LR>(Sf, a, idx, icb);
-      sort::inplace::block<LR>(a, Sl, idx, icb);
+      detail::copy::copies<LR, PAIRS>(Sf, a, idx, icb, cache);
+      detail::copy::copies<LR, PAIRS>(a, Sl, idx, icb, cache);
     } else {
-      sort::inplace::block<LR>(a, Sl, idx, icb);
-      sort::inplace::block<LR>(Sf, a, idx, icb);
+      detail::copy::copies<LR, PAIRS>(a, Sl, idx, icb, cache);
+      detail::copy::copies<LR, PAIRS>(Sf, a, idx, icb, cache);
     }
-  } else  // not enough space
-    sort::inplace::quick<LR>(first, last, index, cb);
+  } else if (!detail::copy::chunked<LR>(first, last, Sf, Sl, index, cb, [Sf, Sl, index, cb, &cache](T a, T b) {
+               detail::copy::quick<LR>(a, b, Sf, Sl, index, cb, cache);
+             }, cache))  // not enough space
+    detail::copy::inplace<LR>(first, last, Sf, Sl, index, cb);
 }
 
-template <int LR = detail::misc::LR, class T, class U, class I>
-inline void quick(T first, T last, U Sf, U Sl, I index) {
+// Same without callbacks
+template <int LR, class T, class U, class I, class K>
+inline void quick(T first, T last, U Sf, U Sl, I index, K &cache) {
   using typeA = std::remove_reference_t<decltype(*Sf)>;
   using typeB = std::remove_reference_t<decltype(*first)>;
   using typeC = std::remove_reference_t<decltype(index(*first))>;
@@ -104,6 +193,7 @@ inline void quick(T first, T last, U Sf, U Sl, I index) {
 
     // get a pivot
     typeC pivot = index(*first);
+    auto nocb = [](auto a, auto b) { (void) a; (void) b; };
 
     // copy together + initial partition
     auto a = Sf, b = Sl;
@@ -115,23 +205,55 @@ inline void quick(T first, T last, U Sf, U Sl, I index) {
     auto idx = [](auto a) { return a.first; };
 
     if (LR) {
-      sort::inplace::block<LR>(Sf, a, idx);
+      detail::copy::copies<LR, PAIRS>(Sf, a, idx, nocb, cache);
       for (auto it = Sf; it != a; ++it)
         first[std::distance(Sf, it)] = it->second;
-      sort::inplace::block<LR>(a, Sl, idx);
+      detail::copy::copies<LR, PAIRS>(a, Sl, idx, nocb, cache);
       for (auto it = a; it != Sl; ++it)
         first[std::distance(Sf, it)] = it->second;
     } else {
-      sort::inplace::block<LR>(a, Sl, idx);
+      detail::copy::copies<LR, PAIRS>(a, Sl, idx, nocb, cache);
       for (auto it = a; it != Sl; ++it)
         first[std::distance(Sf, it)] = it->second;
-      sort::inplace::block<LR>(Sf, a, idx);
+      detail::copy::copies<LR, PAIRS>(Sf, a, idx, nocb, cache);
       for (auto it = Sf; it != a; ++it)
         first[std::distance(Sf, it)] = it->second;
     }
 
-  } else  // not enough space
-    sort::inplace::quick<LR>(first, last, index);
+  } else if (!detail::copy::chunked<LR>(first, last, Sf, Sl, index, [](auto a, auto b) {
+               (void) a; (void) b;
+             }, [Sf, Sl, index, &cache](T a, T b) {
+               detail::copy::quick<LR>(a, b, Sf, Sl, index, cache);
+             }, cache))  // not enough space
+    detail::copy::inplace<LR>(first, last, Sf, Sl, index, [](auto a, auto b) {
+      (void) a; (void) b;
+    });
+}
+
+}  // copy
+}  // detail
+
+namespace copy {
+
+// Oportunistic version of the quicksort
+// Uses free space given to it to copy together key and value
+// then sorting it. Ranges bigger than the free space are split
+// in-place until the pieces fit (see detail::copy::chunked) so a
+// fraction of n is enough.
+template <int LR = detail::misc::LR, class T, class U, class I, class C>
+inline void quick(T first, T last, U Sf, U Sl, I index, C cb) {
+  using typeB = std::remove_reference_t<decltype(*first)>;
+  using typeC = std::remove_reference_t<decltype(index(*first))>;
+  detail::copy::cache<typeB, typeC> cache;
+  detail::copy::quick<LR>(first, last, Sf, Sl, index, cb, cache);
+}
+
+template <int LR = detail::misc::LR, class T, class U, class I>
+inline void quick(T first, T last, U Sf, U Sl, I index) {
+  using typeB = std::remove_reference_t<decltype(*first)>;
+  using typeC = std::remove_reference_t<decltype(index(*first))>;
+  detail::copy::cache<typeB, typeC> cache;
+  detail::copy::quick<LR>(first, last, Sf, Sl, index, cache);
 }
 
 }  // copy
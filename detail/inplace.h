@@ -33,7 +33,9 @@
 #include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <tuple>
 #include <type_traits>
 
@@ -45,14 +47,14 @@ namespace inplace {
 
 template <class T, class I, class V>
 static std::pair<T, T> partition(T first, T last, I index, V pa) {
-  using W = std::remove_reference_t<decltype(*first)>;
+  using W = typename std::iterator_traits<T>::value_type;
   // Doesn't assume that pa is in [first, last)
   // see "Engineering a Sort Function" - BENTLEY, McILROY
 
   auto a = first, c = std::prev(last);
   auto b = first, d = last;
 
-  W bv, cv;
+  W bv = W(), cv = W();  // set before every use, initialized to silence -Wmaybe-uninitialized
   for (V v; b <= c && (v = index(bv = *b)) <= pa; ++b)
     if (v == pa) *b = *a, *a++ = bv;
 
@@ -81,7 +83,7 @@ static std::pair<T, T> partition(T first, T last, I index, V pa) {
 
 template <class T, class I, class V>
 static std::pair<T, T> exchange1(T a, T f, I index, V pa) {
-  using W = std::remove_reference_t<decltype(*a)>;
+  using W = typename std::iterator_traits<T>::value_type;
   // Assumes pa to be at least the median of 3 elements in [a, f)
   // see "Engineering a Sort Function" - BENTLEY, McILROY
 
@@ -115,7 +117,7 @@ static std::pair<T, T> exchange1(T a, T f, I index, V pa) {
 
 template <class T, class I, class V>
 static std::tuple<T, T, T> exchange3(T first, T last, I index, V pa, V pb, V pc) {
-  using W = std::remove_reference_t<decltype(*first)>;
+  using W = typename std::iterator_traits<T>::value_type;
   // Assumes pa < pb < pc and all exists within [first, last)
   // see "How Good is Multi-Pivot Quicksort?" - Aumueller, Dietzfelbinger, Klaue
 
@@ -142,7 +144,7 @@ static std::tuple<T, T, T> exchange3(T first, T last, I index, V pa, V pb, V pc)
 
 template <class T, class I, class V>
 static T exchange_block(T first, T last, I index, V p) {
-  //using W = std::remove_reference_t<decltype(*first)>;
+  //using W = typename std::iterator_traits<T>::value_type;
   // Assumes p is at least median of three and exists within [first, last)
   // see "BlockQuicksort: How Branch Mispredictions don't affect Quicksort" - Edelkamp, Weiss
 
@@ -290,7 +292,7 @@ template <int LR, class T, class I, class C>
 inline void insertion(T first, T last, I index, C cb) {
   // Insertion sort
   if (first != last) for (auto i = first + 1, j = i; i < last; ++i) {
-    auto tmp = *i;
+    typename std::iterator_traits<T>::value_type tmp = *i;
     auto val = index(tmp);
     for (j = i; j > first && val < index(j[-1]); --j)
       *j = j[-1];
@@ -301,22 +303,232 @@ inline void insertion(T first, T last, I index, C cb) {
   return detail::misc::call_range<LR>(first, last, index, cb);
 }
 
-template <int LR, int P, class T, class I, class C>
-static void quick(T first, T last, I index, C &&cb, int budget) {
+// Bounded insertion sort for ranges which look sorted: gives up as soon
+// as more than PARTIAL_MAX moves were needed (the range is still a
+// permutation of the input then). Returns true if the range got sorted
+template <class T, class I>
+inline bool partial_insertion(T first, T last, I index) {
+  std::ptrdiff_t moves = 0;
+  for (auto i = first + 1; i < last; ++i) {
+    if (!(index(*i) < index(i[-1]))) continue;
+    typename std::iterator_traits<T>::value_type tmp = std::move(*i);
+    auto val = index(tmp);
+    auto j = i;
+    do {
+      *j = std::move(j[-1]);
+    } while (--j > first && val < index(j[-1]));
+    *j = std::move(tmp);
+    if ((moves += i - j) > detail::misc::PARTIAL_MAX) return false;
+  }
+  return true;
+}
+
+// Compares 9 equally spaced samples: 1 if ascending, -1 if
+// strictly descending and 0 if there is no obvious order
+template <class T, class I>
+inline int presorted(T first, T last, I index) {
+  auto n = std::distance(first, last) - 1;
+  bool up = true, down = true;
+  auto prev = index(*first);
+  for (int i = 1; i <= 8 && (up || down); ++i) {
+    auto v = index(first[n * i / 8]);
+    up = up && !(v < prev);
+    down = down && v < prev;
+    prev = v;
+  }
+  return up ? 1 : down ? -1 : 0;
+}
+
+// Swaps the sampled positions of a part which got far too big with
+// elements a quarter further in so the next pivot sampling doesn't see
+// the same pattern again (pdqsort's pattern breaking)
+template <class T>
+inline void scramble(T first, T last, std::ptrdiff_t n) {
+  auto m = std::distance(first, last);
+  if (m <= detail::misc::INSERTION_MAX || m < n - n / 8) return;
+  auto q = m / 4, h = m / 2;
+  for (int i = 0; i < 8; ++i) {
+    std::iter_swap(first + i, first + (q + i));
+    std::iter_swap(first + (h - 4 + i), first + (h + q - 4 + i));
+    std::iter_swap(last - 1 - i, last - 1 - (q + i));
+  }
+}
+
+// Bottom-up heap sort (Wegener): the hole left by the root descends along
+// the larger children to a leaf and the element climbs back up from there.
+// The keys of that path are cached so index() is called once per child
+// visited instead of twice per comparison like std::sort_heap does.
+template <class T, class I>
+static void heap(T first, T last, I index) {
+  using W = typename std::iterator_traits<T>::value_type;
+  using V = std::remove_reference_t<decltype(index(*first))>;
+  auto n = std::distance(first, last);
+
+  std::ptrdiff_t nodes[sizeof(std::ptrdiff_t) * CHAR_BIT];
+  V keys[sizeof(std::ptrdiff_t) * CHAR_BIT];
+  auto sift = [&](std::ptrdiff_t i, std::ptrdiff_t m) {
+    W v = std::move(first[i]);
+    auto key = index(v);
+
+    int d = 0;
+    for (auto j = i; 2 * j + 1 < m; j = nodes[d++]) {
+      auto c = 2 * j + 1;
+      V k = index(first[c]);
+      if (c + 1 < m) {
+        V r = index(first[c + 1]);
+        if (k < r) ++c, k = r;
+      }
+      nodes[d] = c, keys[d] = k;
+    }
+    while (d > 0 && !(key < keys[d - 1])) --d;
+
+    auto h = i;
+    for (int t = 0; t < d; h = nodes[t++]) first[h] = std::move(first[nodes[t]]);
+    first[h] = std::move(v);
+  };
+
+  for (auto i = n / 2; i-- > 0;) sift(i, n);
+  for (auto m = n; m-- > 1;) {
+    std::iter_swap(first, first + m);
+    sift(0, m);
+  }
+}
+
+// Merge the sorted runs [first, middle) and [middle, last) using the
+// scratch space [Sf, Sl) of pairs of key and element
+// The shorter run is copied there with its keys so every element is read
+// and its key computed once, a run that doesn't fit is split at its middle
+// and the parts are swapped by a rotation (like std::inplace_merge without
+// a buffer) until one of them does.
+template <class T, class I, class S>
+static void merge(T first, T middle, T last, I index, S Sf, S Sl) {
+  auto n1 = std::distance(first, middle), n2 = std::distance(middle, last);
+  if (n1 == 0 || n2 == 0) return;
+  auto c = std::distance(Sf, Sl);
+
+  if (std::min(n1, n2) > c) {
+    T cut1, cut2;
+    if (n1 > n2) {
+      cut1 = first + n1 / 2;
+      auto k = index(*cut1);
+      cut2 = std::lower_bound(middle, last, k, [&index](const auto &a, const auto &b) { return index(a) < b; });
+    } else {
+      cut2 = middle + n2 / 2;
+      auto k = index(*cut2);
+      cut1 = std::upper_bound(first, middle, k, [&index](const auto &a, const auto &b) { return a < index(b); });
+    }
+    auto mid = std::rotate(cut1, middle, cut2);
+    detail::inplace::merge(first, cut1, mid, index, Sf, Sl);
+    detail::inplace::merge(mid, cut2, last, index, Sf, Sl);
+    return;
+  }
+
+  if (n1 <= n2) {
+    // Left run into the buffer, merge front to back
+    auto e = Sf;
+    for (auto it = first; it != middle; ++it) *e++ = detail::misc::make_pair(index(*it), std::move(*it));
+    auto a = Sf, b = middle, out = first;
+    auto k = index(*b);
+    while (a != e) {
+      if (k < a->first) {
+        *out++ = std::move(*b);
+        if (++b == last) break;
+        k = index(*b);
+      } else {
+        *out++ = std::move((a++)->second);
+      }
+    }
+    while (a != e) *out++ = std::move((a++)->second);
+  } else {
+    // Right run into the buffer, merge back to front
+    auto e = Sf;
+    for (auto it = middle; it != last; ++it) *e++ = detail::misc::make_pair(index(*it), std::move(*it));
+    auto a = e, b = middle, out = last;
+    auto k = index(b[-1]);
+    while (a != Sf) {
+      if (a[-1].first < k) {
+        *--out = std::move(*--b);
+        if (b == first) break;
+        k = index(b[-1]);
+      } else {
+        *--out = std::move((--a)->second);
+      }
+    }
+    while (a != Sf) *--out = std::move((--a)->second);
+  }
+}
+
+// Worst case fallback once the budget is exhausted
+// Without scratch space a key caching heap sort (see heap()), otherwise a
+// bottom-up merge sort which reads the range sequentially: runs as big as
+// half the scratch space are sorted there with their keys, longer ones
+// are merged calling index() about once per element and level (see
+// merge()). Nothing is allocated either way.
+template <int LR, class T, class I, class C>
+static void fallback(T first, T last, I index, C &&cb, std::nullptr_t, std::nullptr_t) {
+  detail::inplace::heap(first, last, index);
+  detail::misc::call_range<LR>(first, last, index, cb);
+}
+
+template <int LR, class T, class I, class C, class S>
+static void fallback(T first, T last, I index, C &&cb, S Sf, S Sl) {
+  auto h = std::distance(Sf, Sl) / 2;
+  if (h < detail::misc::INSERTION_MAX)
+    return detail::inplace::fallback<LR>(first, last, index, cb, nullptr, nullptr);
+
+  // Runs of h elements are merged as pairs of key and element ping-ponging
+  // between both halves of the scratch space so index() is called once
+  auto n = std::distance(first, last);
+  auto key = [](const auto &a, const auto &b) { return a.first < b.first; };
+  auto idx = [](const auto &a) { return a.first; };
+  auto nocb = [](auto a, auto b) { (void) a; (void) b; };
+  const std::ptrdiff_t r = detail::misc::INSERTION_MAX;
+  for (std::ptrdiff_t lo = 0; lo < n; lo += h) {
+    auto m = std::min(h, n - lo);
+    auto a = Sf, b = Sf + h;
+    for (std::ptrdiff_t i = 0; i < m; ++i)
+      a[i] = detail::misc::make_pair(index(first[lo + i]), std::move(first[lo + i]));
+    for (std::ptrdiff_t i = 0; i < m; i += r)
+      detail::inplace::insertion<detail::misc::NOCB>(a + i, a + std::min(i + r, m), idx, nocb);
+    for (auto w = r; w < m; w *= 2, std::swap(a, b))
+      for (std::ptrdiff_t i = 0; i < m; i += 2 * w) {
+        auto x = std::min(i + w, m), y = std::min(i + 2 * w, m);
+        std::merge(std::make_move_iterator(a + i), std::make_move_iterator(a + x),
+                   std::make_move_iterator(a + x), std::make_move_iterator(a + y), b + i, key);
+      }
+    for (std::ptrdiff_t i = 0; i < m; ++i) first[lo + i] = std::move(a[i].second);
+  }
+
+  // Longer runs are merged in the range (see merge())
+  for (auto w = h; w < n; w *= 2)
+    for (std::ptrdiff_t lo = 0; lo + w < n; lo += 2 * w)
+      detail::inplace::merge(first + lo, first + (lo + w), first + std::min(lo + 2 * w, n), index, Sf, Sl);
+
+  detail::misc::call_range<LR>(first, last, index, cb);
+}
+
+// [Sf, Sl) is optional scratch space of pairs of key and element for the
+// worst case fallback
+template <int LR, int P, class T, class I, class C, class S = std::nullptr_t>
+static void quick(T first, T last, I index, C &&cb, int budget, S Sf = nullptr, S Sl = nullptr) {
   using V = std::remove_reference_t<decltype(index(*first))>;
 
   while (1) {
+    auto n = std::distance(first, last);
+
     // Simple insertion sort on small groups
-    if (std::distance(first, last) <= detail::misc::INSERTION_MAX)
+    if (n <= detail::misc::INSERTION_MAX)
       return detail::inplace::insertion<LR>(first, last, index, cb);
 
-    // Switch to heap sort when quicksort degenerates
-    if (budget-- == 0) {
-      auto cmp = detail::misc::compare(index);
-      std::make_heap(first, last, cmp);
-      std::sort_heap(first, last, cmp);
+    // Switch to the fallback when quicksort degenerates
+    if (budget-- == 0)
+      return detail::inplace::fallback<LR>(first, last, index, cb, Sf, Sl);
+
+    // Sorted or reversed input (or parts of it) finish in linear time
+    auto order = detail::inplace::presorted(first, last, index);
+    if (order < 0) std::reverse(first, last);
+    if (order != 0 && detail::inplace::partial_insertion(first, last, index))
       return detail::misc::call_range<LR>(first, last, index, cb);
-    }
 
     V a, b, c;
     std::tie(a, b, c) = detail::inplace::pivot<V>(first, last, index);
@@ -326,14 +538,16 @@ static void quick(T first, T last, I index, C &&cb, int budget) {
       // to three way quicksort
       T d, e;
       std::tie(d, e) = detail::inplace::exchange1(first, last, index, b);
+      detail::inplace::scramble(first, d, n);
+      detail::inplace::scramble(e, last, n);
 
       if (LR) {
-        quick<LR, P>(first, d, index, cb, budget);
+        quick<LR, P>(first, d, index, cb, budget, Sf, Sl);
         if (LR != detail::misc::NOCB)
           cb(d, e);  // equal range callback - must exist
         first = e;  // tail recursion
       } else {
-        quick<LR, P>(e, last, index, cb, budget);
+        quick<LR, P>(e, last, index, cb, budget, Sf, Sl);
         if (LR != detail::misc::NOCB)
           cb(d, e);  // equal range callback - must exist
         last = d;  // tail recursion
@@ -342,33 +556,80 @@ static void quick(T first, T last, I index, C &&cb, int budget) {
       // Three pivot quicksort
       T d, e, f;
       std::tie(d, e, f) = detail::inplace::exchange3(first, last, index, a, b, c);
+      detail::inplace::scramble(first, d, n);
+      detail::inplace::scramble(d, e, n);
+      detail::inplace::scramble(e, f, n);
+      detail::inplace::scramble(f, last, n);
 
       if (LR) {
-        quick<LR, P>(first, d, index, cb, budget);
-        quick<LR, P>(d, e, index, cb, budget);
-        quick<LR, P>(e, f, index, cb, budget);
+        quick<LR, P>(first, d, index, cb, budget, Sf, Sl);
+        quick<LR, P>(d, e, index, cb, budget, Sf, Sl);
+        quick<LR, P>(e, f, index, cb, budget, Sf, Sl);
         first = f;  // tail recursion
       } else {
-        quick<LR, P>(f, last, index, cb, budget);
-        quick<LR, P>(e, f, index, cb, budget);
-        quick<LR, P>(d, e, index, cb, budget);
+        quick<LR, P>(f, last, index, cb, budget, Sf, Sl);
+        quick<LR, P>(e, f, index, cb, budget, Sf, Sl);
+        quick<LR, P>(d, e, index, cb, budget, Sf, Sl);
         last = d;  // tail recursion
       }
     } else {
       // block quicksort
       T d = detail::inplace::exchange_block(first, last, index, b);
+      detail::inplace::scramble(first, d, n);
+      detail::inplace::scramble(d, last, n);
 
       if (LR) {
-        quick<LR, P>(first, d, index, cb, budget);
+        quick<LR, P>(first, d, index, cb, budget, Sf, Sl);
         first = d;  // tail recursion
       } else {
-        quick<LR, P>(d, last, index, cb, budget);
+        quick<LR, P>(d, last, index, cb, budget, Sf, Sl);
         last = d;  // tail recursion
       }
     }
   }
 }
 
+template <int P, class T, class I>
+static void select(T first, T nth, T last, I index, int budget) {
+  using V = std::remove_reference_t<decltype(index(*first))>;
+
+  while (nth < last) {
+    // Simple insertion sort on small groups
+    if (std::distance(first, last) <= detail::misc::INSERTION_MAX)
+      return detail::inplace::insertion<detail::misc::NOCB>(first, last, index, [](auto a, auto b) {
+        (void) a; (void) b;
+      });
+
+    // Introselect: fall back to the library selection when we degenerate
+    if (budget-- == 0)
+      return std::nth_element(first, nth, last, detail::misc::compare(index));
+
+    V a, b, c;
+    std::tie(a, b, c) = detail::inplace::pivot<V>(first, last, index);
+
+    if (a == b || b == c) {
+      // Heavy duplicates - the equal range is already in its final place
+      T d, e;
+      std::tie(d, e) = detail::inplace::exchange1(first, last, index, b);
+      if (nth < d) last = d;
+      else if (e <= nth) first = e;
+      else return;
+    } else if (P == 0) {
+      // Three pivot partitioning - continue in the part holding nth
+      T d, e, f;
+      std::tie(d, e, f) = detail::inplace::exchange3(first, last, index, a, b, c);
+      if (nth < d) last = d;
+      else if (nth < e) first = d, last = e;
+      else if (nth < f) first = e, last = f;
+      else first = f;
+    } else {
+      // block partitioning
+      T d = detail::inplace::exchange_block(first, last, index, b);
+      if (nth < d) last = d; else first = d;
+    }
+  }
+}
+
 }  // inplace
 }  // detail
 }  // sort
@@ -0,0 +1,285 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef SORT_DETAIL_LYNDON_H
+#define SORT_DETAIL_LYNDON_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "misc.h"
+#include "suffix.h"
+#include "../copy.h"
+#include "../inplace.h"
+
+namespace sort {
+namespace detail {
+namespace lyndon {
+
+// Random access view of a text with its alphabet [0, sigma) reversed
+// (symbol c reads as sigma - 1 - c) to sort under the opposite order
+template <class S> class reversed {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::size_t;
+  using reference = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  reversed() = default;
+  reversed(S it, std::size_t sigma) : it_(it), sigma_(sigma) {}
+
+  reference operator*() const { return sigma_ - 1 - detail::suffix::symbol(it_); }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  reversed &operator++() { ++it_; return *this; }
+  reversed &operator--() { --it_; return *this; }
+  reversed operator++(int) { auto t = *this; ++*this; return t; }
+  reversed operator--(int) { auto t = *this; --*this; return t; }
+  reversed &operator+=(difference_type n) { it_ += n; return *this; }
+  reversed &operator-=(difference_type n) { it_ -= n; return *this; }
+
+  friend reversed operator+(reversed a, difference_type n) { return a += n; }
+  friend reversed operator+(difference_type n, reversed a) { return a += n; }
+  friend reversed operator-(reversed a, difference_type n) { return a -= n; }
+  friend difference_type operator-(const reversed &a, const reversed &b) { return a.it_ - b.it_; }
+
+  friend bool operator==(const reversed &a, const reversed &b) { return a.it_ == b.it_; }
+  friend bool operator!=(const reversed &a, const reversed &b) { return a.it_ != b.it_; }
+  friend bool operator<(const reversed &a, const reversed &b) { return a.it_ < b.it_; }
+
+ private:
+  S it_;
+  std::size_t sigma_ = 0;
+};
+
+// Longest common extension of two suffixes of [first, first + n) with
+// its ISA (n + 1 elements as computed by build, read in place). Symbols
+// are compared directly until LCE_BUDGET * n of them are spent, then the
+// LCP array (permuted, Karkkainen, Manzini, Puglisi) and a sparse table
+// of the minima of its blocks of LCE_BLOCK entries are built: a query
+// compares LCE_SCAN symbols and reads the table and the partial blocks at
+// both ends in O(1). Every query costs amortized O(1) and texts with
+// short extensions never build the table (n + n / LCE_BLOCK *
+// log(n / LCE_BLOCK) indices, 2 * n while it is built).
+template <class S, class U> class lce {
+ public:
+  using X = std::remove_reference_t<decltype(*std::declval<U>())>;
+
+  lce(S first, std::ptrdiff_t n, U ISA)
+      : first_(first), n_(n), budget_(detail::misc::LCE_BUDGET * n), ISA_(ISA) {}
+
+  // Length of the longest common prefix of the suffixes a and b, at
+  // most cap
+  std::ptrdiff_t operator()(std::ptrdiff_t a, std::ptrdiff_t b, std::ptrdiff_t cap = std::numeric_limits<std::ptrdiff_t>::max()) {
+    std::ptrdiff_t k = 0, m = std::min(n_ - std::max(a, b), cap);
+    auto top = std::min<std::ptrdiff_t>(m, lcp_.empty() ? budget_ : detail::misc::LCE_SCAN);
+    while (k < top && symbol(a + k) == symbol(b + k)) ++k;
+    if (lcp_.empty()) budget_ -= k;
+    if (k < top || k == m) return k;
+
+    if (lcp_.empty()) build();
+    std::ptrdiff_t l = ISA_[a], r = ISA_[b];
+    if (l > r) std::swap(l, r);
+    return std::min<std::ptrdiff_t>(minimum(l + 1, r + 1), m);
+  }
+
+ private:
+  std::size_t symbol(std::ptrdiff_t i) const { return detail::suffix::symbol(first_ + i); }
+
+  void build() {
+    // lcp_ holds SA, PLCP[i] is the LCP of i and its predecessor in SA
+    // (Phi[i]) and is at least PLCP[i - 1] - 1 like in Kasai
+    std::vector<X> P(n_ + 1);
+    lcp_.resize(n_ + 1);
+    for (std::ptrdiff_t i = 0; i <= n_; ++i) lcp_[ISA_[i]] = static_cast<X>(i);
+    for (std::ptrdiff_t r = 1; r <= n_; ++r) P[lcp_[r]] = lcp_[r - 1];
+    for (std::ptrdiff_t i = 0, h = 0; i < n_; ++i) {
+      std::ptrdiff_t j = P[i];
+      if (j == n_) h = 0;  // follows the sentinel
+      while (i + h < n_ && j + h < n_ && symbol(i + h) == symbol(j + h)) ++h;
+      P[i] = static_cast<X>(h);
+      if (h > 0) --h;
+    }
+    lcp_[0] = 0;
+    for (std::ptrdiff_t r = 1; r <= n_; ++r) lcp_[r] = P[lcp_[r]];
+
+    constexpr std::ptrdiff_t B = detail::misc::LCE_BLOCK;
+    blocks_ = n_ / B + 1;
+    auto levels = detail::misc::ilogb(blocks_) + 1;
+    table_.resize(levels * blocks_);
+    for (std::ptrdiff_t b = 0; b < blocks_; ++b)
+      table_[b] = *std::min_element(lcp_.begin() + b * B, lcp_.begin() + std::min(b * B + B, n_ + 1));
+    for (std::ptrdiff_t k = 1; k < levels; ++k)
+      for (std::ptrdiff_t b = 0; b + (1 << k) <= blocks_; ++b)
+        table_[k * blocks_ + b] = std::min(table_[(k - 1) * blocks_ + b],
+                                           table_[(k - 1) * blocks_ + b + (1 << (k - 1))]);
+  }
+
+  // Minimum of lcp_ in [f, l), f < l
+  std::ptrdiff_t minimum(std::ptrdiff_t f, std::ptrdiff_t l) const {
+    constexpr std::ptrdiff_t B = detail::misc::LCE_BLOCK;
+    auto bf = f / B, bl = (l - 1) / B;
+    if (bf == bl) return *std::min_element(lcp_.begin() + f, lcp_.begin() + l);
+    auto m = std::min(*std::min_element(lcp_.begin() + f, lcp_.begin() + (bf + 1) * B),
+                      *std::min_element(lcp_.begin() + bl * B, lcp_.begin() + l));
+    if (bf + 1 < bl) {
+      auto k = detail::misc::ilogb(bl - bf - 1);
+      m = std::min({m, table_[k * blocks_ + bf + 1], table_[k * blocks_ + bl - (1 << k)]});
+    }
+    return m;
+  }
+
+  S first_;
+  std::ptrdiff_t n_, budget_, blocks_ = 0;
+  U ISA_;
+  std::vector<X> lcp_, table_;
+};
+
+// Report the runs whose Lyndon roots are the longest Lyndon words L[i]
+// of the text [first, first + n) under one order of the alphabet.
+// A root at i with period p = L[i] spans a run if the text repeats with
+// period p for l symbols to its left and r to its right with l + r >= p,
+// l and r are read from the longest common extensions lce (amortized O(1)).
+// Every run has such a root under the order with T[e] < T[e - p]
+// (e the end of the run, the end of the text being the smallest) so
+// it is reported under that order only (order 0 if it ends the text).
+// The roots of one run are p apart: the first one (l < p) is extended
+// and clears the later ones in L (the sum of the exponents of the runs
+// is O(n)). l is scanned up to LCE_SCAN symbols and galloped over beyond
+// (the text repeats for y symbols to the left iff y <= l) so a run costs
+// O(log p) and every other root O(1).
+template <class S, class L, class C, class F>
+inline void runs(S first, std::ptrdiff_t n, bool order, L Lf, C &lce, F f) {
+  auto symbol = [first](std::ptrdiff_t i) { return detail::suffix::symbol(first + i); };
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    std::ptrdiff_t p = Lf[i], j = i + p;
+    if (p == 0 || j == n) continue;  // cleared or at the end
+
+    auto left = [&lce, i, j](std::ptrdiff_t y) { return lce(i - y, j - y, y) == y; };
+    std::ptrdiff_t r = lce(i, j), l = 0, top = std::min(p - 1, i);
+    while (l < top && l < detail::misc::LCE_SCAN && symbol(i - l - 1) == symbol(j - l - 1)) ++l;
+    if (l == detail::misc::LCE_SCAN && l < top) {
+      l = std::max(l, p - r);
+      if (l > top || !left(l)) continue;
+      std::ptrdiff_t step = 1;
+      while (l + step <= top && left(l + step)) l += step, step *= 2;
+      while (step /= 2)
+        if (l + step <= top && left(l + step)) l += step;
+    }
+    if (l + r < p) continue;
+
+    auto s = i - l, e = j + r;
+    for (auto k = j; k + p <= e; k += p)
+      if (Lf[k] == p) Lf[k] = 0;
+    if (e == n ? !order : (symbol(e) < symbol(e - p)) != order)
+      f(s, e - s, p);
+  }
+}
+
+// Sort the conjugates of the Lyndon factors of [first, first + n) by
+// the order of their infinite periodic repetitions (omega order)
+// SA and ISA hold the suffix array of the text (n + 1 elements as
+// computed by build), L its Lyndon array and N the next word of every
+// position: p + L[p] or the start of its factor at its end (N[s] == s
+// for a factor s). A conjugate is the chain of the words L[p] up to the
+// end of its factor followed by the factor forever, a suffix the same
+// chain followed by the next factors. Both compare word by word (a word
+// which is a prefix of another one is the smaller) so the suffixes
+// sharing their first word are consecutive in SA and the groups of SA
+// are the groups of the conjugates: a pass like Kasai's LCP flags their
+// ends in place. Left to right within the group of the word u those
+// followed by a smaller word are sorted by its rank, those followed by
+// u again are induced from the one after it (p - |u| precedes p) and the
+// factors equal to u repeat u forever and come last. Linear besides the
+// sorts. On return [SA + 1, SA + n + 1) holds the conjugates and ISA
+// their index in it, [Pf, Pl) is scratch space for the sorts.
+template <class S, class T, class U, class L, class V, class P>
+inline void conjugates(S first, std::ptrdiff_t n, T SA, U ISA, L Lf, V Nf, P Pf, P Pl) {
+  using X = std::remove_reference_t<decltype(*ISA)>;
+  using Y = std::remove_reference_t<decltype(*SA)>;
+  auto castToIndex = detail::misc::castTo<X>();
+  auto symbol = [first](std::ptrdiff_t i) { return detail::suffix::symbol(first + i); };
+  detail::copy::cache<Y, X> cache;  // shared by all groups
+
+  // Flag the last suffix of every group of equal first words
+  for (std::ptrdiff_t i = 0, h = 0; i < n; ++i) {
+    std::ptrdiff_t r = ISA[i];
+    if (r == 1) {
+      h = 0;
+      continue;
+    }
+    std::ptrdiff_t j = SA[r - 1] < 0 ? ~SA[r - 1] : SA[r - 1], l = Lf[i];
+    if (Lf[j] == l)
+      while (h < l && symbol(i + h) == symbol(j + h)) ++h;
+    if (Lf[j] != l || h < l) SA[r - 1] = ~SA[r - 1];
+    if (h > 0) --h;
+  }
+  SA[n] = ~SA[n];
+
+  // ISA keeps the ranks of the suffixes: those of a group are in its
+  // range of SA, the ones before are final and smaller
+  for (std::ptrdiff_t gf = 1, gl = 1; gf <= n; gf = gl) {
+    while (0 <= SA[gl++]);  // End of the group is flagged
+    SA[gl - 1] = ~SA[gl - 1];
+    if (gl - gf == 1) continue;
+
+    // Those followed by a smaller word to the front, the factors equal
+    // to u to the back, the slots of the others are refilled below
+    auto mid = gf, last = gl;
+    for (auto i = gf; i < last;) {
+      std::ptrdiff_t p = SA[i];
+      if (ISA[Nf[p]] < gf)
+        SA[mid++] = SA[i++];
+      else if (Nf[p] == p)
+        SA[i] = SA[--last], SA[last] = castToIndex(p);
+      else
+        ++i;
+    }
+    auto key = [&](std::ptrdiff_t p) { return ISA[Nf[p]]; };
+    detail::copy::quick<detail::misc::NOCB>(SA + gf, SA + mid, Pf, Pl, key, cache);
+
+    // The one preceding p is placed once p is, only it is followed by p
+    for (auto i = gf, fill = mid; i < fill; ++i) {
+      std::ptrdiff_t p = SA[i];
+      ISA[p] = castToIndex(i);
+      if (mid == last) continue;  // none is followed by u again
+      std::ptrdiff_t q = p - Lf[p];
+      if (q >= 0 && Nf[q] == p && ISA[q] >= gf && ISA[q] < gl) SA[fill++] = castToIndex(q);
+    }
+    for (auto i = last; i < gl; ++i) ISA[SA[i]] = castToIndex(i);
+  }
+}
+
+}  // lyndon
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_LYNDON_H
@@ -0,0 +1,92 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#ifndef SORT_DETAIL_LZ_H
+#define SORT_DETAIL_LZ_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <cstddef>
+
+#include "misc.h"
+#include "suffix.h"
+
+namespace sort {
+namespace detail {
+namespace lz {
+
+// Previous and next smaller value of every text position in the suffix
+// array [SA, SA + rows): P[i] and N[i] are the closest rows above and below
+// the one of i holding a smaller position (-1 if there is none). These are
+// the lexicographic neighbours among the suffixes to the left of i so one
+// of them shares the longest prefix with it.
+// A single scan with a stack (Kärkkäinen, Kempa, Puglisi: KKP3) where the
+// stack is linked through P itself: below x lies P[x] and the position
+// popping x is N[x]. The sentinel row (position n) is skipped.
+template <class T, class U, class V>
+inline void neighbours(T SA, std::ptrdiff_t rows, std::ptrdiff_t n, U P, V N) {
+  auto castToIndex = detail::misc::castTo<decltype(*P)>();
+  std::ptrdiff_t top = -1;
+  for (std::ptrdiff_t r = 0; r < rows; ++r) {
+    std::ptrdiff_t x = SA[r];
+    if (x == n) continue;
+    while (top > x) {
+      N[top] = castToIndex(x);
+      top = P[top];
+    }
+    P[x] = castToIndex(top);
+    top = x;
+  }
+  for (; top >= 0; top = P[top]) N[top] = castToIndex(-1);
+}
+
+// Greedy LZ77 parse of [first, first + n) from the neighbours P and N
+// Every factor is the longest prefix of the rest that occurred before
+// (possibly overlapping it) and f(source, length) is called for each left
+// to right, a symbol seen for the first time is f(symbol, 0).
+// Only factor starts are compared, at most length + 1 symbols for each of
+// the two candidates, so this is O(n).
+template <class S, class U, class V, class F>
+inline void parse(S first, std::ptrdiff_t n, U P, V N, F f) {
+  auto lcp = [first, n](std::ptrdiff_t i, std::ptrdiff_t j) {
+    std::ptrdiff_t l = 0;
+    if (j < 0) return l;
+    while (i + l < n && detail::suffix::symbol(first + i + l) == detail::suffix::symbol(first + j + l)) ++l;
+    return l;
+  };
+  for (std::ptrdiff_t i = 0; i < n;) {
+    std::ptrdiff_t p = P[i], q = N[i];
+    auto a = lcp(i, p), b = lcp(i, q);
+    if (b > a) a = b, p = q;
+    if (a == 0)
+      f(static_cast<std::ptrdiff_t>(detail::suffix::symbol(first + i)), std::ptrdiff_t(0)), ++i;
+    else
+      f(p, a), i += a;
+  }
+}
+
+}  // lz
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_LZ_H
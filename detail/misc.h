@@ -42,11 +42,28 @@ constexpr const int LR   = 1;  // Direction: left to right
 constexpr const int RL   = 0;  // Direction: right to left
 
 constexpr const int INSERTION_MAX =   32;  // When to switch to insertion sort
+constexpr const int PARTIAL_MAX   =    8;  // Moves before giving up on a presorted range
 constexpr const int MEDIAN21      =   64;  // When to switch to pseudo median of 21
 constexpr const int MEDIAN65      = 8192;  // When to switch to pseudo median of 65
 constexpr const int BLOCK_SIZE    =  128;  // Block Size for block partition ~2 cache lines
 constexpr const int COPY_MIN      = 1024;  // Minimum number of elements to use copy
                                            // probably around number of cache lines in L1 cache * 2
+constexpr const int BUCKET_MAX    = 65536;  // Alphabet size always grouped by direct bucketing
+constexpr const int RADIX_BITS    =   11;  // Bits per pass of the LSD radix sort (2048 buckets)
+constexpr const int SAMPLE_BUCKETS =  256;  // Maximum number of samplesort buckets (without equality buckets)
+constexpr const int SAMPLE_BLOCK  = 2048;  // Bytes per block of the samplesort distribution
+constexpr const int SAMPLE_MIN    = 65536;  // Minimum number of elements to use samplesort
+constexpr const int SAMPLE_COPY_MIN = 1 << 22;  // Minimum number of copies sorted with samplesort
+constexpr const int CHUNK_MIN     = 1 << 20;  // Minimum chunk of the parallel suffix sorter
+constexpr const int CHUNK_STEP    =  256;  // Symbols per thread between the suffixes it ranks in every chunk
+constexpr const int LCE_BUDGET    =   16;  // Symbols compared directly per symbol of the text before building the LCE table
+constexpr const int LCE_SCAN      =   64;  // Symbols compared directly before a longest common extension query
+constexpr const int LCE_BLOCK     =   64;  // LCP entries per block of the longest common extension table
+constexpr const int QUERY_GROUP   =   16;  // Binary searches interleaved to overlap their cache misses
+constexpr const int QUERY_SHARD   = 4096;  // Patterns per job of the multithreaded query engine
+constexpr const int SCATTER_MIN   = 1 << 16;  // Minimum number of ISA updates to buffer
+constexpr const int SCATTER_REGION = 1 << 14;  // Elements of ISA one buffered region covers (64 KiB of int)
+constexpr const int SCATTER_BUCKETS = 1024;  // Maximum number of regions (bounded by the TLB)
 
 template<class T1, class T2>
 struct pair {
@@ -93,7 +110,9 @@ struct has_xor_operator<T, decltype(void(std::declval<T>() ^ std::declval<T>()))
 
 template <class T> int ilogb(T v) {
 #if defined(__GNUC__)
-  return (31 - __builtin_clz(v));
+  if (sizeof(T) > sizeof(unsigned))
+    return (63 - __builtin_clzll(static_cast<unsigned long long>(v)));
+  return (31 - __builtin_clz(static_cast<unsigned>(v)));
 #else
   int r = 0;
   while (v >>= 1)
@@ -102,15 +121,31 @@ template <class T> int ilogb(T v) {
 #endif
 }
 
+inline int popcount(std::uint64_t v) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(static_cast<unsigned long long>(v));
+#else
+  int r = 0;
+  for (; v; v &= v - 1)
+    ++r;
+  return r;
+#endif
+}
+
+template <class V> inline void cswap(V &a, V &b, std::true_type) {
+  std::remove_reference_t<V> da = a, db = b, tmp;
+  tmp = a = da < db ? da : db;
+  b ^= da ^ tmp;
+}
+
+template <class V> inline void cswap(V &a, V &b, std::false_type) {
+  if (b < a) std::swap(a, b);
+}
+
 template <class V> inline void cswap(V &a, V &b) {
 #if defined(__GNUC__) || defined(_MSC_VER) && !defined(__clang__) && !defined(__INTEL_COMPILER)
-  if (has_xor_operator<V>::value) {
-    std::remove_reference_t<V> da = a, db = b, tmp;
-    tmp = a = da < db ? da : db;
-    b ^= da ^ tmp;
-  } else {
-    if (b < a) std::swap(a, b);
-  }
+  // dispatch at compile time so types without ^ (e.g. floating point) still compile
+  cswap(a, b, has_xor_operator<V>());
 #else
   // clang+icc nicely optimize this into cmoves
   if (b < a) std::swap(a, b);
@@ -282,6 +317,15 @@ inline auto index(U ISA, D depth) {
   return [ISAd = ISA + depth](auto a) { return ISAd[a]; };
 }
 
+// Hint that *p will be read soon (no-op where unsupported)
+template <class V> inline void prefetch(const V *p) {
+#if defined(__GNUC__)
+  __builtin_prefetch(p);
+#else
+  (void) p;
+#endif
+}
+
 template <class A>
 auto castTo() {
   return [](auto val) { return static_cast<std::remove_reference_t<A>>(val); };
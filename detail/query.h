@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#ifndef SORT_DETAIL_QUERY_H
+#define SORT_DETAIL_QUERY_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "misc.h"
+#include "suffix.h"
+
+namespace sort {
+namespace detail {
+namespace query {
+
+// One binary search over the rows [lo, hi) of a SA
+// l and r are the lcp of the pattern with the rows lo - 1 and hi, every
+// row in between shares min(l, r) symbols with it (Manber, Myers: mlr)
+struct state {
+  std::ptrdiff_t lo, hi, l, r, mid, pos;
+};
+
+// Compare the suffix at pos of [first, first + n) with the pattern
+// [pf, pf + m) knowing they share k symbols
+// Returns their lcp and whether the suffix belongs left of the bound:
+// it's smaller than the pattern or (upper) has it as a prefix
+template <class S, class P>
+inline std::pair<std::ptrdiff_t, bool> compare(S first, std::ptrdiff_t n, std::ptrdiff_t pos,
+                                               P pf, std::ptrdiff_t m, std::ptrdiff_t k, bool upper) {
+  auto s = first + pos;
+  auto e = std::min(m, n - pos);
+  while (k < e && detail::suffix::symbol(s + k) == detail::suffix::symbol(pf + k)) ++k;
+  if (k == m) return std::make_pair(k, upper);
+  if (k == e) return std::make_pair(k, true);  // the suffix ran out
+  return std::make_pair(k, detail::suffix::symbol(s + k) < detail::suffix::symbol(pf + k));
+}
+
+// Binary search of the patterns [pf[i], pf[i] + m[i]) for i in [0, k) in
+// lockstep. Every step walks all searches three times: computing the
+// middles and prefetching their SA entries, loading them and prefetching
+// the text they point at and finally comparing, so the cache misses of
+// up to k searches overlap instead of being paid one after another.
+// On return lo == hi is the first row not left of the bound (see compare).
+template <class S, class T, class P, class M, class G>
+inline void search(S first, std::ptrdiff_t n, T SA, P pf, M m, G st, std::ptrdiff_t k, bool upper) {
+  for (bool active = true; active;) {
+    active = false;
+    for (std::ptrdiff_t i = 0; i < k; ++i) {
+      auto& s = st[i];
+      if (s.lo >= s.hi) continue;
+      s.mid = s.lo + (s.hi - s.lo) / 2;
+      detail::misc::prefetch(&*(SA + s.mid));
+    }
+    for (std::ptrdiff_t i = 0; i < k; ++i) {
+      auto& s = st[i];
+      if (s.lo >= s.hi) continue;
+      s.pos = static_cast<std::ptrdiff_t>(SA[s.mid]);
+      if (s.pos < n) detail::misc::prefetch(&*(first + std::min(s.pos + std::min(s.l, s.r), n - 1)));
+    }
+    for (std::ptrdiff_t i = 0; i < k; ++i) {
+      auto& s = st[i];
+      if (s.lo >= s.hi) continue;
+      auto c = compare(first, n, s.pos, pf[i], m[i], std::min(s.l, s.r), upper);
+      if (c.second)
+        s.lo = s.mid + 1, s.l = c.first;
+      else
+        s.hi = s.mid, s.r = c.first;
+      active |= s.lo < s.hi;
+    }
+  }
+}
+
+}  // query
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_QUERY_H
@@ -0,0 +1,410 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// In-place Super Scalar Samplesort
+//  see "In-place Parallel Super Scalar Samplesort (IPS4o)" - Axtmann, Witt, Ferizovic, Sanders
+//  and "Super Scalar Sample Sort" - Sanders, Winkel
+
+#ifndef SORT_DETAIL_SAMPLE_H
+#define SORT_DETAIL_SAMPLE_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "misc.h"
+#include "inplace.h"
+#include "thread.h"
+
+namespace sort {
+namespace detail {
+namespace sample {
+
+// Everything a single thread needs to distribute a range
+// allocated once and reused on every level of the recursion
+template <class W, class V> struct buffers {
+  explicit buffers(std::ptrdiff_t block)
+      : block(block),
+        data(2 * detail::misc::SAMPLE_BUCKETS * block),
+        swap(block), overflow(block),
+        fill(2 * detail::misc::SAMPLE_BUCKETS),
+        count(2 * detail::misc::SAMPLE_BUCKETS + 1),
+        write(2 * detail::misc::SAMPLE_BUCKETS),
+        read(2 * detail::misc::SAMPLE_BUCKETS),
+        tree(detail::misc::SAMPLE_BUCKETS),
+        splitters(detail::misc::SAMPLE_BUCKETS) {
+    bounds.reserve(2 * count.size());
+  }
+
+  using value_type = W;
+
+  // Push the first m bucket boundaries of the last distribution, they
+  // are needed after the recursion overwrote count. Returns their offset
+  // in bounds, pop(offset) releases them again.
+  std::ptrdiff_t push(std::ptrdiff_t m) {
+    auto o = static_cast<std::ptrdiff_t>(bounds.size());
+    bounds.insert(bounds.end(), count.begin(), count.begin() + m);
+    return o;
+  }
+  void pop(std::ptrdiff_t o) { bounds.resize(static_cast<std::size_t>(o)); }
+
+  std::ptrdiff_t block;
+  std::vector<W> data, swap, overflow;
+  std::vector<std::ptrdiff_t> fill, count, write, read, bounds;
+  std::vector<V> tree, splitters;
+};
+
+// Number of elements per block - blocks of about 2 KB
+template <class W> constexpr std::ptrdiff_t block() {
+  return sizeof(W) < detail::misc::SAMPLE_BLOCK ? detail::misc::SAMPLE_BLOCK / sizeof(W) : 1;
+}
+
+// One set of buffers of each type B, allocated on first use so a whole
+// sort can share them without paying for the ones it never needs
+template <class... B> class cache {
+ public:
+  template <std::size_t K> auto &get() {
+    using X = std::tuple_element_t<K, std::tuple<B...>>;
+    auto &p = std::get<K>(buffers_);
+    if (!p) p.reset(new X(detail::sample::block<typename X::value_type>()));
+    return *p;
+  }
+
+ private:
+  std::tuple<std::unique_ptr<B>...> buffers_;
+};
+
+// Smallest range worth a distribution step (16 blocks for each of 16 buckets)
+template <class W> constexpr std::ptrdiff_t minimum() {
+  return std::max<std::ptrdiff_t>(detail::misc::SAMPLE_MIN, 256 * block<W>());
+}
+
+// Branchless classification: descend the implicit search tree and then
+// check the splitter at the leaf to route equal keys to their own bucket.
+// Bucket 2 * i holds (s[i - 1], s[i]) and bucket 2 * i + 1 holds s[i]
+template <class V> struct classifier {
+  const V *tree, *splitters;
+  int log;
+
+  std::ptrdiff_t operator()(const V &v) const {
+    std::ptrdiff_t i = 1;
+    for (int l = 0; l < log; ++l)
+      i = 2 * i + (tree[i] < v);
+    i -= std::ptrdiff_t(1) << log;
+    return 2 * i + (v == splitters[i]);
+  }
+
+  // Descend the tree for 4 elements level by level so their loads are
+  // independent and can be in flight at the same time. Named locals
+  // rather than arrays keep them in registers without loop unrolling.
+  template <class T, class I>
+  void operator()(T it, I index, std::ptrdiff_t *b) const {
+    V v0 = index(it[0]), v1 = index(it[1]), v2 = index(it[2]), v3 = index(it[3]);
+    std::ptrdiff_t c0 = 1, c1 = 1, c2 = 1, c3 = 1;
+    for (int l = 0; l < log; ++l) {
+      c0 = 2 * c0 + (tree[c0] < v0); c1 = 2 * c1 + (tree[c1] < v1);
+      c2 = 2 * c2 + (tree[c2] < v2); c3 = 2 * c3 + (tree[c3] < v3);
+    }
+    auto k = std::ptrdiff_t(1) << log;
+    c0 -= k; c1 -= k; c2 -= k; c3 -= k;
+    b[0] = 2 * c0 + (v0 == splitters[c0]); b[1] = 2 * c1 + (v1 == splitters[c1]);
+    b[2] = 2 * c2 + (v2 == splitters[c2]); b[3] = 2 * c3 + (v3 == splitters[c3]);
+  }
+};
+
+// Fill tree[node] with the splitters [lo, hi) in search tree order
+template <class V>
+inline void build(V *tree, const V *s, std::ptrdiff_t node, std::ptrdiff_t lo, std::ptrdiff_t hi) {
+  if (lo >= hi) return;
+  auto mid = lo + (hi - lo) / 2;
+  tree[node] = s[mid];
+  build(tree, s, 2 * node + 0, lo, mid);
+  build(tree, s, 2 * node + 1, mid + 1, hi);
+}
+
+// Pick the splitters from a sorted sample at the front of the range
+// returns the log of the number of leaves or 0 if the sample is useless
+template <class T, class I, class B>
+static int splitters(T first, T last, I index, B &buf) {
+  using V = std::remove_reference_t<decltype(index(*first))>;
+  auto n = std::distance(first, last);
+
+  // Oversampling factor of about 0.2 * log(n)
+  int log = std::min(detail::misc::ilogb(n / (16 * buf.block)), detail::misc::ilogb(detail::misc::SAMPLE_BUCKETS));
+  auto k = std::ptrdiff_t(1) << log;
+  auto size = std::min<std::ptrdiff_t>(k * std::max(1, detail::misc::ilogb(n) / 5), n / 2);
+
+  // Move a pseudo random sample to the front and sort it
+  std::uint64_t state = 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(n);
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+    std::iter_swap(first + i, first + (i + static_cast<std::ptrdiff_t>(state % static_cast<std::uint64_t>(n - i))));
+  }
+  int budget = 2 * detail::misc::ilogb(size + 1);
+  detail::inplace::quick<detail::misc::NOCB, 0>(first, first + size, index, [](auto a, auto b) {
+    (void) a; (void) b;
+  }, budget);
+
+  // Equally spaced unique splitters
+  std::ptrdiff_t m = 0;
+  for (std::ptrdiff_t i = 1; i < k; ++i) {
+    V v = index(first[i * size / k - 1]);
+    if (m == 0 || buf.splitters[m - 1] < v) buf.splitters[m++] = v;
+  }
+  if (m == 0) return 0;
+
+  // Shrink to the smallest tree holding all unique splitters and pad with the maximum
+  log = 1;
+  while ((std::ptrdiff_t(1) << log) <= m) ++log;
+  k = std::ptrdiff_t(1) << log;
+  for (auto i = m; i < k; ++i) buf.splitters[i] = buf.splitters[m - 1];
+  detail::sample::build(buf.tree.data(), buf.splitters.data(), 1, 0, k - 1);
+  return log;
+}
+
+// Classification of the stripe [first, last): collect every bucket in the
+// buffer block of buf and flush full blocks to the front of the stripe.
+// We never overtake the read position. On return buf.count[b + 1] holds
+// the flushed elements of bucket b and buf.fill[b] the buffered ones,
+// the flushed blocks end at the returned position.
+template <class T, class I, class V, class B>
+static T classify(T first, T last, I index, const classifier<V> &classify, B &buf, std::ptrdiff_t nb) {
+  auto bs = buf.block;
+  std::fill(buf.fill.begin(), buf.fill.begin() + nb, 0);
+  std::fill(buf.count.begin(), buf.count.begin() + nb + 1, 0);
+  auto w = first;
+  auto *data = buf.data.data();
+  auto *fill = buf.fill.data();
+  auto put = [&](T it, std::ptrdiff_t b) {
+    auto *bb = data + b * bs;
+    auto f = fill[b];
+    bb[f] = *it;
+    if (++f == bs) {
+      w = std::copy(bb, bb + bs, w);
+      f = 0;
+      buf.count[b + 1] += bs;
+    }
+    fill[b] = f;
+  };
+
+  auto it = first;
+  for (; last - it >= 4; it += 4) {
+    std::ptrdiff_t b[4];
+    classify(it, index, b);
+    for (int j = 0; j < 4; ++j) put(it + j, b[j]);
+  }
+  for (; it != last; ++it) put(it, classify(index(*it)));
+  return w;
+}
+
+// Distribute [first, last) into 2 * 2^log buckets in place after the k
+// stripes [first + s[t], first + s[t + 1]) were classified into buf[t]
+// (their flushed blocks ending at e[t]). On return buf[0].count holds the
+// bucket boundaries relative to first.
+template <class T, class I, class V, class B>
+static void permute(T first, T last, I index, const classifier<V> &classify, B *buf, std::ptrdiff_t k,
+                    const std::ptrdiff_t *s, const T *e, std::ptrdiff_t nb) {
+  auto n = std::distance(first, last);
+  auto bs = buf[0].block;
+  auto &count = buf[0].count;
+
+  // Move the flushed blocks of all stripes together and add up the buckets
+  auto w = e[0];
+  for (std::ptrdiff_t t = 1; t < k; ++t) {
+    w = std::move(first + s[t], e[t], w);
+    for (std::ptrdiff_t b = 0; b < nb; ++b) count[b + 1] += buf[t].count[b + 1];
+  }
+  for (std::ptrdiff_t t = 0; t < k; ++t)
+    for (std::ptrdiff_t b = 0; b < nb; ++b) count[b + 1] += buf[t].fill[b];
+  for (std::ptrdiff_t b = 0; b < nb; ++b) count[b + 1] += count[b];
+  auto full = std::distance(first, w);
+
+  // Block permutation: bucket b owns the block slots in
+  // [roundup(d[b]), roundup(d[b + 1])) - swap each block into its bucket
+  auto roundup = [bs](std::ptrdiff_t v) { return (v + bs - 1) / bs * bs; };
+  auto &write = buf[0].write, &read = buf[0].read;
+  for (std::ptrdiff_t b = 0; b < nb; ++b) {
+    write[b] = roundup(count[b]);
+    read[b] = std::min(roundup(count[b + 1]), full) - bs;
+  }
+
+  std::ptrdiff_t overflow = -1;
+  auto *held = buf[0].swap.data();
+  for (std::ptrdiff_t b = 0; b < nb; ++b) {
+    while (read[b] >= write[b]) {
+      std::copy(first + read[b], first + (read[b] + bs), held);
+      read[b] -= bs;
+
+      auto t = classify(index(held[0]));
+      while (write[t] <= read[t]) {
+        // Slot still holds an unprocessed block - exchange and continue with it
+        for (decltype(bs) i = 0; i < bs; ++i) {
+          auto tmp = static_cast<std::remove_reference_t<decltype(*held)>>(first[write[t] + i]);
+          first[write[t] + i] = std::move(held[i]);
+          held[i] = std::move(tmp);
+        }
+        write[t] += bs;
+        t = classify(index(held[0]));
+      }
+
+      // Empty slot - the last one might stick out of the range
+      if (write[t] + bs > n) {
+        overflow = write[t];
+        std::copy(held, held + bs, buf[0].overflow.begin());
+      } else {
+        std::copy(held, held + bs, first + write[t]);
+      }
+      write[t] += bs;
+    }
+  }
+  if (overflow >= 0)
+    std::copy(buf[0].overflow.begin(), buf[0].overflow.begin() + (n - overflow), first + overflow);
+
+  // Cleanup: move the part of the blocks sticking into the next bucket and
+  // the partially filled buffers of all stripes into the head and the tail
+  // gap of each bucket
+  for (std::ptrdiff_t b = 0; b < nb; ++b) {
+    // Blocks of b are in [roundup(lo), e), the head is [lo, s), the tail gap [e, hi)
+    auto lo = count[b], hi = count[b + 1];
+    auto h = std::min(roundup(lo), hi), end = write[b];
+    std::ptrdiff_t t = 0, i = 0;
+    auto src = [&]() -> decltype(*held) {
+      while (i == buf[t].fill[b]) ++t, i = 0;
+      return buf[t].data[b * bs + i++];
+    };
+
+    auto dst = lo;
+    for (auto p = std::max(hi, roundup(lo)); p < end; ++p)
+      first[dst++] = (overflow >= 0 && p >= n) ? buf[0].overflow[p - overflow] : first[p];
+    for (; dst < h; ++dst) first[dst] = src();
+    for (dst = std::min(end, hi); dst < hi; ++dst) first[dst] = src();
+  }
+}
+
+// Distribute [first, last) into 2 * 2^log buckets in place
+// on return buf.count holds the bucket boundaries relative to first
+template <class T, class I, class B>
+static void distribute(T first, T last, I index, B &buf, int log) {
+  using V = std::remove_reference_t<decltype(index(*first))>;
+  auto nb = std::ptrdiff_t(2) << log;
+  detail::sample::classifier<V> classify{buf.tree.data(), buf.splitters.data(), log};
+  std::ptrdiff_t s[] = {0, std::distance(first, last)};
+  T e[] = {detail::sample::classify(first, last, index, classify, buf, nb)};
+  detail::sample::permute(first, last, index, classify, &buf, 1, s, e, nb);
+}
+
+template <int LR, int P, class T, class I, class C, class B>
+static void sort(T first, T last, I index, C &&cb, B &buf, int budget) {
+  using W = typename std::iterator_traits<T>::value_type;
+  auto n = std::distance(first, last);
+
+  int log;
+  if (n < detail::sample::minimum<W>() || budget-- == 0
+      || (log = detail::sample::splitters(first, last, index, buf)) == 0) {
+    int qbudget = 2 * detail::misc::ilogb(n + 1);
+    return detail::inplace::quick<LR, P>(first, last, index, cb, qbudget);
+  }
+
+  detail::sample::distribute(first, last, index, buf, log);
+
+  // Buckets are overwritten by the recursion so keep the boundaries
+  auto nb = std::ptrdiff_t(2) << log;
+  auto d = buf.push(nb + 1);
+
+  auto recurse = [&](std::ptrdiff_t b) {
+    auto bf = first + buf.bounds[d + b], bl = first + buf.bounds[d + b + 1];
+    if (bf == bl) return;
+    if (b & 1) {
+      // Equality bucket - all keys equal the splitter
+      if (LR != detail::misc::NOCB) cb(bf, bl);
+    } else {
+      detail::sample::sort<LR, P>(bf, bl, index, cb, buf, budget);
+    }
+  };
+
+  if (LR) for (std::ptrdiff_t b = 0; b < nb; ++b) recurse(b);
+  else for (std::ptrdiff_t b = nb; b-- > 0;) recurse(b);
+  buf.pop(d);
+}
+
+// Parallel version without callbacks: the top level classification runs
+// on one stripe per thread, the block permutation on the calling thread,
+// then the buckets are sorted by the pool (biggest first) with one set of
+// buffers per thread
+template <class T, class I>
+static void parallel(T first, T last, I index, unsigned threads) {
+  using W = typename std::iterator_traits<T>::value_type;
+  using V = std::remove_reference_t<decltype(index(*first))>;
+  auto n = std::distance(first, last);
+  auto nocb = [](auto a, auto b) { (void) a; (void) b; };
+  int budget = detail::misc::ilogb(n + 1);
+
+  detail::thread::pool pool(threads);
+  std::vector<detail::sample::buffers<W, V>> buf(pool.size(),
+    detail::sample::buffers<W, V>(detail::sample::block<W>()));
+
+  int log;
+  if (n < detail::sample::minimum<W>() || (log = detail::sample::splitters(first, last, index, buf[0])) == 0)
+    return detail::sample::sort<detail::misc::NOCB, 0>(first, last, index, nocb, buf[0], budget);
+
+  // Stripes of at least one distribution step each
+  auto nb = std::ptrdiff_t(2) << log;
+  auto k = std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(pool.size(), n / detail::sample::minimum<W>()));
+  std::vector<std::ptrdiff_t> s(k + 1);
+  std::vector<T> e(k, first);
+  for (std::ptrdiff_t t = 0; t <= k; ++t) s[t] = n / k * t + std::min(t, n % k);
+
+  detail::sample::classifier<V> classify{buf[0].tree.data(), buf[0].splitters.data(), log};
+  pool.run(k, [&](unsigned, std::size_t t) {
+    e[t] = detail::sample::classify(first + s[t], first + s[t + 1], index, classify, buf[t], nb);
+  });
+  detail::sample::permute(first, last, index, classify, buf.data(), k, s.data(), e.data(), nb);
+
+  // Only the non equality buckets need more work. The boundaries are
+  // copied once as every thread's recursion reuses its own buffers.
+  std::vector<std::ptrdiff_t> d(buf[0].count.begin(), buf[0].count.begin() + nb + 1);
+  std::vector<std::ptrdiff_t> jobs;
+  for (std::ptrdiff_t b = 0; b < nb; b += 2)
+    if (d[b + 1] - d[b] > 1) jobs.push_back(b);
+  sort::detail::inplace::quick<detail::misc::NOCB, 0>(jobs.begin(), jobs.end(), [&d](std::ptrdiff_t b) {
+    return d[b] - d[b + 1];  // biggest first
+  }, nocb, detail::misc::ilogb(jobs.size() + 1));
+
+  pool.run(jobs.size(), [&](unsigned w, std::size_t j) {
+    auto b = jobs[j];
+    detail::sample::sort<detail::misc::NOCB, 0>(first + d[b], first + d[b + 1], index, nocb, buf[w], budget);
+  });
+}
+
+}  // sample
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_SAMPLE_H
@@ -28,16 +28,20 @@
 #endif
 
 #include <algorithm>
+#include <array>
 #include <climits>
 #include <cmath>
 #include <cstdint>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "misc.h"
+#include "zip.h"
 #include "../inplace.h"
 #include "../copy.h"
+#include "../key.h"
 
 // define if additional space may be used
 #define USE_COPY
@@ -118,6 +122,143 @@ static T partition(T SA, U ISA, T first, T last, D depth) {
   return detail::suffix::induce(SA, ISA, first, a, b, last, depth, first - SA);
 }
 
+// Symbol of an integer text as an unsigned value (chars may be signed)
+template <class S> inline std::size_t symbol(S it) {
+  using W = std::remove_cv_t<std::remove_reference_t<decltype(*it)>>;
+  return static_cast<std::size_t>(static_cast<std::make_unsigned_t<W>>(*it));
+}
+
+// Group SA and ISA of the text [first, last) by its first symbol
+// using direct bucketing (one counter per symbol in [0, sigma))
+// A unique sentinel smaller than every symbol is appended at position n
+// so SA and ISA need room for n + 1 elements
+template <class S, class T, class U>
+inline void bucket(S first, S last, std::size_t sigma, T SA, U ISA) {
+  auto n = std::distance(first, last);
+  auto castToIndex = detail::misc::castTo<decltype(*ISA)>();
+
+  // Bucket 0 is reserved for the sentinel
+  std::vector<std::ptrdiff_t> start(sigma + 1);
+  start[0] = 1;
+  for (auto it = first; it != last; ++it)
+    ++start[1 + detail::suffix::symbol(it)];
+
+  // Exclusive scan - the name of each group is its start in SA
+  std::ptrdiff_t sum = 0;
+  for (auto &s : start) {
+    auto t = s; s = sum; sum += t;
+  }
+
+  SA[0] = castToIndex(n);
+  ISA[n] = castToIndex(0);
+  auto pos = start;
+  for (decltype(n) i = 0; i < n; ++i) {
+    auto c = 1 + detail::suffix::symbol(first + i);
+    ISA[i] = castToIndex(start[c]);
+    SA[pos[c]++] = castToIndex(i);
+  }
+}
+
+// Byte alphabet
+template <class S, class T, class U>
+inline void bucket(S first, S last, T SA, U ISA) {
+  detail::suffix::bucket(first, last, 256, SA, ISA);
+}
+
+// Group SA and ISA of the text [first, last) by its first symbol
+// using a LSD radix sort for alphabets too big to count directly.
+// ISA doubles as the buffer of the radix passes.
+template <class S, class T, class U>
+inline void radix(S first, S last, std::size_t sigma, T SA, U ISA) {
+  auto n = std::distance(first, last);
+  auto castToIndex = detail::misc::castTo<decltype(*ISA)>();
+
+  constexpr const int RADIX_BITS = detail::misc::RADIX_BITS;
+  constexpr const std::size_t RADIX_MASK = (std::size_t(1) << RADIX_BITS) - 1;
+  std::vector<std::ptrdiff_t> count(RADIX_MASK + 1);
+
+  // Sort [SA + 1, SA + n + 1) by the symbols, ping-ponging through ISA
+  auto pass = [first, n, &count](auto a, auto b, int shift) {
+    std::fill(count.begin(), count.end(), 0);
+    for (decltype(n) i = 0; i < n; ++i)
+      ++count[(detail::suffix::symbol(first + a[i]) >> shift) & RADIX_MASK];
+    std::ptrdiff_t sum = 0;
+    for (auto &c : count) {
+      auto t = c; c = sum; sum += t;
+    }
+    for (decltype(n) i = 0; i < n; ++i)
+      b[count[(detail::suffix::symbol(first + a[i]) >> shift) & RADIX_MASK]++] = a[i];
+  };
+
+  // Start in ISA if the number of passes is odd so the last one ends in SA
+  int passes = 0;
+  for (int shift = 0; shift < static_cast<int>(sizeof(std::size_t) * CHAR_BIT)
+                      && ((sigma - 1) >> shift) != 0; shift += RADIX_BITS)
+    ++passes;
+  bool inSA = passes % 2 == 0;
+  for (decltype(n) i = 0; i < n; ++i) {
+    if (inSA) SA[i + 1] = castToIndex(i); else ISA[i + 1] = castToIndex(i);
+  }
+  for (int p = 0; p < passes; ++p) {
+    if (inSA) pass(SA + 1, ISA + 1, p * RADIX_BITS); else pass(ISA + 1, SA + 1, p * RADIX_BITS);
+    inSA = !inSA;
+  }
+
+  // Name each group by its start in SA
+  SA[0] = castToIndex(n);
+  ISA[n] = castToIndex(0);
+  std::ptrdiff_t g = 1;
+  for (decltype(n) r = 1; r <= n; ++r) {
+    if (1 < r && detail::suffix::symbol(first + SA[r - 1]) != detail::suffix::symbol(first + SA[r]))
+      g = r;
+    ISA[SA[r]] = castToIndex(g);
+  }
+}
+
+// Pick direct bucketing for alphabets we can afford a counter per symbol
+template <class S, class T, class U>
+inline void group(S first, S last, std::size_t sigma, T SA, U ISA) {
+  auto n = static_cast<std::size_t>(std::distance(first, last));
+  if (sigma <= std::max<std::size_t>(detail::misc::BUCKET_MAX, n / 4))
+    detail::suffix::bucket(first, last, sigma, SA, ISA);
+  else
+    detail::suffix::radix(first, last, sigma, SA, ISA);
+}
+
+// Group SA and ISA of the documents [first + D[d], first + D[d + 1])
+// Every document is followed by its own sentinel at virtual position D[d + 1] + d
+// Sentinels are smaller than every byte and ordered by decreasing document
+// so the last one is the smallest suffix (as daware requires)
+// SA and ISA need room for n + k elements
+template <class S, class B, class T, class U>
+inline void documents(S first, B Df, B Dl, T SA, U ISA) {
+  auto k = std::distance(Df, Dl) - 1;
+  auto n = static_cast<std::ptrdiff_t>(Df[k]);
+  auto castToIndex = detail::misc::castTo<decltype(*ISA)>();
+
+  std::array<std::ptrdiff_t, 257> start{};
+  for (auto it = first; it != first + n; ++it)
+    ++start[1 + static_cast<unsigned char>(*it)];
+
+  // Exclusive scan behind the k sentinel groups
+  std::ptrdiff_t sum = k;
+  for (auto &s : start) {
+    auto t = s; s = sum; sum += t;
+  }
+
+  auto pos = start;
+  for (decltype(k) d = 0; d < k; ++d) {
+    for (auto i = static_cast<std::ptrdiff_t>(Df[d]); i < static_cast<std::ptrdiff_t>(Df[d + 1]); ++i) {
+      auto c = 1 + static_cast<unsigned char>(first[i]);
+      ISA[i + d] = castToIndex(start[c]);
+      SA[pos[c]++] = castToIndex(i + d);
+    }
+    auto s = static_cast<std::ptrdiff_t>(Df[d + 1]) + d;
+    ISA[s] = castToIndex(k - 1 - d);
+    SA[k - 1 - d] = castToIndex(s);
+  }
+}
+
 template <class T, class U, class D>
 inline auto name(T SA, U ISA, D depth) {
   return [SA, ISA, depth = depth + 1](auto a, auto b) {
@@ -150,6 +291,216 @@ inline auto name(T SA, U ISA, D depth) {
   };
 }
 
+// Rank update ISA[SA[i]] = i for all i in [first, last) of an SA with n
+// elements. The writes are random over the whole ISA so big ranges are
+// first radix partitioned by the region of ISA they hit into the scratch
+// space [Sf, Sl) and then written region by region. Each region stays in
+// the cache while it is written instead of a write-allocate miss per rank.
+template <class T, class U, class S>
+inline void scatter(T SA, U ISA, T first, T last, std::ptrdiff_t n, S Sf, S Sl) {
+  auto castToIndex = detail::misc::castTo<decltype(*ISA)>();
+  auto m = std::distance(first, last);
+  if (m < detail::misc::SCATTER_MIN || std::distance(Sf, Sl) < m) {
+    for (auto it = first; it != last; ++it)
+      ISA[*it] = castToIndex(it - SA);
+    return;
+  }
+
+  // Regions of at least SCATTER_REGION elements, at most SCATTER_BUCKETS of them
+  int shift = detail::misc::ilogb(detail::misc::SCATTER_REGION);
+  while ((n >> shift) >= detail::misc::SCATTER_BUCKETS) ++shift;
+
+  std::array<std::ptrdiff_t, detail::misc::SCATTER_BUCKETS> count{};
+  for (auto it = first; it != last; ++it)
+    ++count[static_cast<std::size_t>(*it) >> shift];
+  std::ptrdiff_t sum = 0;
+  for (auto &c : count) {
+    auto t = c; c = sum; sum += t;
+  }
+
+  using X = decltype(Sf->first);
+  using Y = decltype(Sf->second);
+  for (auto it = first; it != last; ++it)
+    Sf[count[static_cast<std::size_t>(*it) >> shift]++] =
+      detail::misc::make_pair(static_cast<X>(it - SA), static_cast<Y>(*it));
+
+  for (auto it = Sf; it != Sf + m; ++it)
+    ISA[it->second] = castToIndex(it->first);
+}
+
+// Compare the suffixes a and b of the text [first, first + n)
+// symbol by symbol, a suffix running out first is the smaller one
+template <class S>
+inline bool less(S first, std::ptrdiff_t n, std::ptrdiff_t a, std::ptrdiff_t b) {
+  auto l = n - std::max(a, b);
+  auto m = std::mismatch(first + a, first + (a + l), first + b);
+  if (m.first != first + (a + l))
+    return detail::suffix::symbol(m.first) < detail::suffix::symbol(m.second);
+  return a > b;
+}
+
+// The first 128 bits worth of symbols of suffix a (padded with zeros)
+// Two suffixes with different prefixes compare like their prefixes,
+// equal prefixes need a full comparison
+template <class S>
+inline std::pair<std::uint64_t, std::uint64_t> prefix(S first, std::ptrdiff_t n, std::ptrdiff_t a) {
+  using W = std::remove_cv_t<std::remove_reference_t<decltype(*first)>>;
+  constexpr int bits = sizeof(W) < 8 ? 8 * sizeof(W) : 64;
+  std::uint64_t v[2] = {0, 0};
+  for (int w = 0; w < 2; ++w) {
+    for (int i = 0; i < 64 / bits; ++i, ++a) {
+      v[w] = bits < 64 ? v[w] << (bits % 64) : 0;
+      if (a < n) v[w] |= detail::suffix::symbol(first + a);
+    }
+  }
+  return std::make_pair(v[0], v[1]);
+}
+
+// Length of the longest suffix of [first, first + n) which is a prefix
+// of another suffix (occurs earlier in the text), given SA and ISA of
+// n + 1 elements. Such a suffix has all longer ones following it directly
+// in SA so checking the next rank is enough. If the suffix of length l
+// repeats so does the one of length l - 1: exponential and binary search.
+template <class S, class T, class U>
+inline std::ptrdiff_t repeated(S first, std::ptrdiff_t n, T SA, U ISA) {
+  auto repeats = [&](std::ptrdiff_t l) {
+    auto i = n - l;
+    auto r = static_cast<std::ptrdiff_t>(ISA[i]);
+    if (r == n) return false;
+    auto j = static_cast<std::ptrdiff_t>(SA[r + 1]);
+    return j < i && std::equal(first + i, first + n, first + j);
+  };
+
+  std::ptrdiff_t lo = 0, hi = 1;  // repeats(lo) holds, repeats(hi) doesn't
+  while (hi <= n && repeats(hi)) lo = hi, hi *= 2;
+  hi = std::min(hi, n + 1);
+  while (hi - lo > 1) {
+    auto mid = lo + (hi - lo) / 2;
+    (repeats(mid) ? lo : hi) = mid;
+  }
+  return lo;
+}
+
+// Merge the sorted suffixes [Uf, Ul) of the text [first, first + n) into
+// the sorted suffixes [SA, SA + s) which have room for all of them.
+// Every one is binary searched and the merge runs from the back so
+// nothing is overwritten before it was moved.
+template <class S, class T, class U>
+inline void insert(S first, std::ptrdiff_t n, T SA, std::ptrdiff_t s, U Uf, U Ul) {
+  auto d = s + std::distance(Uf, Ul);
+  for (auto it = Ul; it != Uf;) {
+    auto y = static_cast<std::ptrdiff_t>(*--it);
+    auto p = std::partition_point(SA, SA + s, [&](std::ptrdiff_t x) {
+      return detail::suffix::less(first, n, x, y);
+    }) - SA;
+    while (s > p) SA[--d] = SA[--s];
+    SA[--d] = *it;
+  }
+}
+
+// Sort the suffixes starting at [SA, SA + b) of the text [first, first + n)
+// by their first limit symbols (limit >= n sorts them completely)
+// Multikey quicksort on the cached 128 bit prefixes with an explicit stack:
+// ranges of equal prefixes are sorted again 128 bits deeper. The number of
+// symbols left (up to one prefix) is part of the key so a suffix running
+// out is smaller and never recursed into. head[i] is set to 1 if SA[i]
+// differs from SA[i - 1] and to 0 if they are equal up to limit.
+template <class S, class T, class H>
+inline void sparse(S first, std::ptrdiff_t n, T SA, std::ptrdiff_t b, std::ptrdiff_t limit, H head) {
+  using W = std::remove_cv_t<std::remove_reference_t<decltype(*first)>>;
+  using K = std::tuple<std::uint64_t, std::uint64_t, std::ptrdiff_t>;
+  constexpr std::ptrdiff_t window = 2 * (sizeof(W) < 8 ? 8 / sizeof(W) : 1);
+  if (b == 0) return;
+
+  std::vector<K> keys(b);
+  std::vector<std::tuple<std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t>> stack;
+  stack.emplace_back(0, b, 0);
+  std::fill(head, head + b, 0);
+  head[0] = 1;
+
+  while (!stack.empty()) {
+    std::ptrdiff_t lo, hi, depth;
+    std::tie(lo, hi, depth) = stack.back();
+    stack.pop_back();
+
+    for (auto i = lo; i < hi; ++i) {
+      auto p = static_cast<std::ptrdiff_t>(SA[i]);
+      auto end = p + std::min(limit, n - p);
+      auto pre = detail::suffix::prefix(first, end, p + depth);
+      keys[i] = K(pre.first, pre.second, std::min(end - (p + depth), window));
+    }
+
+    auto z = detail::zip::make(keys.begin(), SA);
+    sort::inplace::quick(z + lo, z + hi, [](const auto &a) { return a.first; }, [&](auto f, auto l) {
+      auto i = f - z, j = l - z;
+      if (i != lo) head[i] = 1;
+      if (j - i > 1 && std::get<2>(*f.key()) == window)
+        stack.emplace_back(i, j, depth + window);
+    });
+  }
+}
+
+// Sort the suffixes [SA, SA + n) of the text [first, first + n) by their
+// first limit symbols like sparse() but on a compacted alphabet: every
+// symbol is replaced by its rank among the occuring ones (0 past the end)
+// and as many as fit are packed into a single 64 bit key (21 for DNA).
+// The keys are sorted by sort_by_key and groups of equal keys whose last
+// symbol is not past the end are sorted again one key deeper.
+// Alphabets with symbols beyond 32 bits are left to sparse().
+template <class S, class T, class H>
+inline void kmers(S first, std::ptrdiff_t n, T SA, std::ptrdiff_t limit, H head) {
+  if (n == 0) return;
+  std::size_t top = 0;
+  for (std::ptrdiff_t i = 0; i < n; ++i) top = std::max(top, detail::suffix::symbol(first + i));
+  if (top > UINT32_MAX) return detail::suffix::sparse(first, n, SA, n, limit, head);
+
+  // Rank of every occuring symbol starting at 1
+  std::vector<std::uint32_t> rank;
+  std::size_t sigma = top + 1;
+  if (top < static_cast<std::size_t>(detail::misc::BUCKET_MAX)) {
+    rank.assign(top + 1, 0);
+    for (std::ptrdiff_t i = 0; i < n; ++i) rank[detail::suffix::symbol(first + i)] = 1;
+    sigma = 0;
+    for (auto &r : rank) if (r) r = static_cast<std::uint32_t>(++sigma);
+  }
+  auto code = [first, &rank](std::ptrdiff_t i) -> std::uint64_t {
+    auto c = detail::suffix::symbol(first + i);
+    return rank.empty() ? c + 1 : rank[c];
+  };
+
+  int bits = detail::misc::ilogb(sigma) + 1;
+  std::ptrdiff_t window = 64 / bits;
+  std::uint64_t last = (std::uint64_t(1) << bits) - 1;
+  auto word = [n, limit, window, bits, code](std::ptrdiff_t p, std::ptrdiff_t depth) {
+    auto end = p + std::min(limit, n - p);
+    std::uint64_t w = 0;
+    for (auto q = p + depth; q < p + depth + window; ++q)
+      w = w << bits | (q < end ? code(q) : 0);
+    return w;
+  };
+
+  std::vector<std::uint64_t> keys(n);
+  std::vector<std::tuple<std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t>> stack;
+  stack.emplace_back(0, n, 0);
+  std::fill(head, head + n, 0);
+  head[0] = 1;
+
+  auto kf = keys.begin();
+  while (!stack.empty()) {
+    std::ptrdiff_t lo, hi, depth;
+    std::tie(lo, hi, depth) = stack.back();
+    stack.pop_back();
+
+    for (auto i = lo; i < hi; ++i) keys[i] = word(SA[i], depth);
+    sort::sort_by_key(kf + lo, kf + hi, SA + lo, [&](auto f, auto l) {
+      auto i = f - kf, j = l - kf;
+      if (i != lo) head[i] = 1;
+      if (j - i > 1 && (*f & last) != 0 && depth + window < limit)
+        stack.emplace_back(i, j, depth + window);
+    });
+  }
+}
+
 }  // suffix
 }  // detail
 }  // sort
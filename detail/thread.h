@@ -0,0 +1,136 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Minimal persistent thread pool
+//  workers are started once and pull jobs from a shared counter
+
+#ifndef SORT_DETAIL_THREAD_H
+#define SORT_DETAIL_THREAD_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sort {
+namespace detail {
+namespace thread {
+
+class pool {
+ public:
+  // threads is the total number of workers including the calling thread
+  // 0 means one per hardware thread
+  explicit pool(unsigned threads = 0) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (unsigned w = 1; w < threads; ++w)
+      workers_.emplace_back([this, w] { work(w); });
+  }
+
+  ~pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &t : workers_) t.join();
+  }
+
+  pool(const pool &) = delete;
+  pool &operator=(const pool &) = delete;
+
+  unsigned size() const { return static_cast<unsigned>(workers_.size() + 1); }
+
+  // Call f(worker, job) for every job in [0, jobs) and block until all are done
+  // Jobs are handed out in increasing order so callers can schedule by
+  // sorting them beforehand. The calling thread is worker 0.
+  // If a job throws no further jobs are handed out and the first exception
+  // is rethrown once every worker is done (they reference this frame)
+  template <class F> void run(std::size_t jobs, F f) {
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    auto task = [this, &next, jobs, &f, &error](unsigned w) {
+      try {
+        for (std::size_t j; (j = next++) < jobs;) f(w, j);
+      } catch (...) {
+        next = jobs;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error) error = std::current_exception();
+      }
+    };
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = std::ref(task);
+      busy_ = static_cast<unsigned>(workers_.size());
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+    if (error) std::rethrow_exception(error);
+  }
+
+ private:
+  void work(unsigned w) {
+    std::size_t seen = 0;
+    while (true) {
+      std::function<void(unsigned)> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        task = task_;
+      }
+
+      task(w);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_ == 0) done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_, done_;
+  std::function<void(unsigned)> task_;
+  std::size_t generation_ = 0;
+  unsigned busy_ = 0;
+  bool stop_ = false;
+};
+
+}  // thread
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_THREAD_H
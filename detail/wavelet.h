@@ -0,0 +1,139 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Wavelet Matrix
+//  rank and access on a byte sequence in about 9 bits per symbol
+//  (used for the BWT of the FM-index)
+
+#ifndef SORT_DETAIL_WAVELET_H
+#define SORT_DETAIL_WAVELET_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "misc.h"
+
+namespace sort {
+namespace detail {
+namespace wavelet {
+
+// Bitvector with one cumulative counter every 512 bits
+class bits {
+ public:
+  bits() = default;
+  explicit bits(std::size_t n) : words_(n / 64 + 1) {}
+
+  void set(std::size_t i) { words_[i / 64] |= std::uint64_t(1) << (i % 64); }
+  bool operator[](std::size_t i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+
+  // Must be called once all bits are set
+  void build() {
+    ranks_.assign(words_.size() / 8 + 1, 0);
+    std::size_t sum = 0;
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      if (w % 8 == 0) ranks_[w / 8] = sum;
+      sum += detail::misc::popcount(words_[w]);
+    }
+  }
+
+  // Number of ones in [0, i)
+  std::size_t rank1(std::size_t i) const {
+    auto r = ranks_[i / 512];
+    for (auto w = i / 512 * 8; w < i / 64; ++w) r += detail::misc::popcount(words_[w]);
+    if (i % 64) r += detail::misc::popcount(words_[i / 64] & ((std::uint64_t(1) << (i % 64)) - 1));
+    return r;
+  }
+
+  std::size_t rank0(std::size_t i) const { return i - rank1(i); }
+
+ private:
+  std::vector<std::uint64_t> words_;
+  std::vector<std::size_t> ranks_;
+};
+
+// Level l holds bit 7 - l of every symbol after the symbols were stably
+// sorted by their higher bits (zeros first, zeros_[l] of them)
+class matrix {
+ public:
+  matrix() = default;
+
+  template <class S> matrix(S first, S last) : n_(std::distance(first, last)) {
+    std::vector<unsigned char> cur(first, last), next(n_);
+    for (int l = 0; l < 8; ++l) {
+      levels_[l] = bits(n_);
+      std::size_t z = 0;
+      for (std::size_t i = 0; i < n_; ++i)
+        if ((cur[i] >> (7 - l)) & 1) levels_[l].set(i); else ++z;
+      levels_[l].build();
+      zeros_[l] = z;
+
+      // Stable partition by the current bit
+      std::size_t a = 0, b = z;
+      for (std::size_t i = 0; i < n_; ++i)
+        next[(cur[i] >> (7 - l)) & 1 ? b++ : a++] = cur[i];
+      cur.swap(next);
+    }
+  }
+
+  std::size_t size() const { return n_; }
+
+  unsigned char operator[](std::size_t i) const {
+    unsigned c = 0;
+    for (int l = 0; l < 8; ++l) {
+      bool b = levels_[l][i];
+      c = c << 1 | b;
+      i = b ? zeros_[l] + levels_[l].rank1(i) : levels_[l].rank0(i);
+    }
+    return static_cast<unsigned char>(c);
+  }
+
+  // Number of c in [0, i)
+  std::size_t rank(unsigned char c, std::size_t i) const {
+    std::size_t lo = 0;
+    for (int l = 0; l < 8; ++l) {
+      if ((c >> (7 - l)) & 1) {
+        lo = zeros_[l] + levels_[l].rank1(lo);
+        i = zeros_[l] + levels_[l].rank1(i);
+      } else {
+        lo = levels_[l].rank0(lo);
+        i = levels_[l].rank0(i);
+      }
+    }
+    return i - lo;
+  }
+
+ private:
+  std::size_t n_ = 0;
+  std::array<bits, 8> levels_;
+  std::array<std::size_t, 8> zeros_{};
+};
+
+}  // wavelet
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_WAVELET_H
@@ -0,0 +1,123 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Zip Iterator
+//  walks two columns in lockstep so the partitioners can move keys and
+//  values together without ever storing them as pairs
+
+#ifndef SORT_DETAIL_ZIP_H
+#define SORT_DETAIL_ZIP_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "misc.h"
+
+namespace sort {
+namespace detail {
+namespace zip {
+
+// Proxy reference to one row: assigning through it writes both columns
+template <class K, class V> struct reference {
+  using value_type = detail::misc::pair<std::remove_const_t<K>, std::remove_const_t<V>>;
+
+  K &first;
+  V &second;
+
+  operator value_type() const { return value_type(first, second); }
+
+  reference &operator=(const value_type &rhs) {
+    first = rhs.first;
+    second = rhs.second;
+    return *this;
+  }
+
+  reference &operator=(const reference &rhs) {
+    first = rhs.first;
+    second = rhs.second;
+    return *this;
+  }
+
+  friend void swap(reference a, reference b) {
+    using std::swap;
+    swap(a.first, b.first);
+    swap(a.second, b.second);
+  }
+};
+
+template <class I, class J> class iterator {
+  using K = std::remove_reference_t<decltype(*std::declval<I>())>;
+  using V = std::remove_reference_t<decltype(*std::declval<J>())>;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using reference = detail::zip::reference<K, V>;
+  using value_type = typename reference::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  iterator() = default;
+  iterator(I k, J v) : k_(k), v_(v) {}
+
+  I key() const { return k_; }
+  J value() const { return v_; }
+
+  reference operator*() const { return reference{*k_, *v_}; }
+  reference operator[](difference_type n) const { return reference{k_[n], v_[n]}; }
+
+  iterator &operator++() { ++k_; ++v_; return *this; }
+  iterator &operator--() { --k_; --v_; return *this; }
+  iterator operator++(int) { auto t = *this; ++*this; return t; }
+  iterator operator--(int) { auto t = *this; --*this; return t; }
+  iterator &operator+=(difference_type n) { k_ += n; v_ += n; return *this; }
+  iterator &operator-=(difference_type n) { k_ -= n; v_ -= n; return *this; }
+
+  friend iterator operator+(iterator a, difference_type n) { return a += n; }
+  friend iterator operator+(difference_type n, iterator a) { return a += n; }
+  friend iterator operator-(iterator a, difference_type n) { return a -= n; }
+  friend difference_type operator-(const iterator &a, const iterator &b) { return a.k_ - b.k_; }
+
+  friend bool operator==(const iterator &a, const iterator &b) { return a.k_ == b.k_; }
+  friend bool operator!=(const iterator &a, const iterator &b) { return a.k_ != b.k_; }
+  friend bool operator<(const iterator &a, const iterator &b) { return a.k_ < b.k_; }
+  friend bool operator>(const iterator &a, const iterator &b) { return a.k_ > b.k_; }
+  friend bool operator<=(const iterator &a, const iterator &b) { return a.k_ <= b.k_; }
+  friend bool operator>=(const iterator &a, const iterator &b) { return a.k_ >= b.k_; }
+
+ private:
+  I k_;
+  J v_;
+};
+
+template <class I, class J> inline iterator<I, J> make(I k, J v) {
+  return iterator<I, J>(k, v);
+}
+
+}  // zip
+}  // detail
+}  // sort
+
+#endif  // SORT_DETAIL_ZIP_H
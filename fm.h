@@ -0,0 +1,160 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// FM-Index
+//  builds the BWT, its rank structure and the SA / ISA samples straight
+//  from the final induction of daware
+
+#ifndef SORT_FM_H
+#define SORT_FM_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "detail/suffix.h"
+#include "detail/wavelet.h"
+#include "suffix.h"
+
+namespace sort {
+namespace fm {
+
+// FM-index of a byte text of n symbols. Row 0 is the sentinel suffix and
+// the BWT holds a placeholder 0 in the row of the whole text (primary).
+// Every rate-th row keeps its SA value and every rate-th text position
+// its row, so locate() and extract() take O(rate) LF steps.
+// T is the index type of the temporary SA and ISA (n must fit)
+template <class T = std::int32_t> class index {
+ public:
+  template <class S> index(S Tf, S Tl, std::size_t rate = 32) : n_(std::distance(Tf, Tl)), rate_(rate) {
+    std::vector<unsigned char> bwt(n_ + 1);
+    sa_.resize(n_ / rate_ + 1);
+    isa_.resize(n_ / rate_ + 1);
+    {
+      // SA and ISA only live during the construction. Everything is taken
+      // from the ranges daware finished last so nothing is read twice
+      std::vector<T> SA(n_ + 1), ISA(n_ + 1);
+      detail::suffix::bucket(Tf, Tl, SA.begin(), ISA.begin());
+      auto SAf = SA.begin();
+      auto emit = [&](auto first, auto last) {
+        for (auto it = first; it != last; ++it) {
+          auto r = static_cast<std::size_t>(it - SAf);
+          auto p = static_cast<std::size_t>(*it);
+          if (p == 0)
+            primary_ = r;
+          else
+            bwt[r] = static_cast<unsigned char>(detail::suffix::symbol(Tf + (p - 1)));
+          if (r % rate_ == 0) sa_[r / rate_] = p;
+          if (p % rate_ == 0) isa_[p / rate_] = r;
+        }
+      };
+#ifdef USE_COPY
+      std::vector<T> A(n_ + 1);
+      sort::suffix::daware(SA.begin(), SA.end(), ISA.begin(), A.begin(), A.end(), emit);
+#else
+      sort::suffix::daware(SA.begin(), SA.end(), ISA.begin(), emit);
+#endif
+    }
+
+    // C[c] - first row of the suffixes starting with c
+    C_.fill(0);
+    for (std::size_t r = 0; r <= n_; ++r)
+      if (r != primary_) ++C_[bwt[r] + 1];
+    C_[0] = 1;
+    for (std::size_t c = 1; c < C_.size(); ++c) C_[c] += C_[c - 1];
+
+    wavelet_ = detail::wavelet::matrix(bwt.begin(), bwt.end());
+  }
+
+  std::size_t size() const { return n_; }
+  std::size_t rate() const { return rate_; }
+
+  // Rows [first, second) of the suffixes starting with [Pf, Pl)
+  template <class P> std::pair<std::size_t, std::size_t> find(P Pf, P Pl) const {
+    std::size_t lo = 0, hi = n_ + 1;
+    for (auto it = Pl; it != Pf && lo < hi;) {
+      auto c = static_cast<unsigned char>(detail::suffix::symbol(--it));
+      lo = C_[c] + rank(c, lo);
+      hi = C_[c] + rank(c, hi);
+    }
+    return lo < hi ? std::make_pair(lo, hi) : std::make_pair(lo, lo);
+  }
+
+  // Number of occurences of [Pf, Pl)
+  template <class P> std::size_t count(P Pf, P Pl) const {
+    auto r = find(Pf, Pl);
+    return r.second - r.first;
+  }
+
+  // Text position of the suffix in row r
+  std::size_t locate(std::size_t r) const {
+    std::size_t steps = 0;
+    for (; r % rate_ != 0; ++steps) {
+      if (r == primary_) return steps;
+      r = lf(r);
+    }
+    return sa_[r / rate_] + steps;
+  }
+
+  // Write the text [pos, pos + len) to out
+  template <class O> O extract(std::size_t pos, std::size_t len, O out) const {
+    len = std::min(len, n_ - std::min(pos, n_));
+    auto end = pos + len;
+    auto p = std::min((end + rate_ - 1) / rate_ * rate_, n_);
+    auto r = p == n_ ? std::size_t(0) : isa_[p / rate_];
+
+    std::vector<unsigned char> buf(len);
+    for (; p > pos; --p) {
+      if (p <= end) buf[p - 1 - pos] = wavelet_[r];
+      r = lf(r);
+    }
+    return std::copy(buf.begin(), buf.end(), out);
+  }
+
+ private:
+  // Occurences of c in the BWT rows [0, i) without the placeholder
+  std::size_t rank(unsigned char c, std::size_t i) const {
+    return wavelet_.rank(c, i) - (c == 0 && primary_ < i);
+  }
+
+  // Row of the suffix one position to the left
+  std::size_t lf(std::size_t r) const {
+    auto c = wavelet_[r];
+    return C_[c] + rank(c, r);
+  }
+
+  std::size_t n_, rate_, primary_ = 0;
+  std::array<std::size_t, 257> C_;
+  std::vector<std::size_t> sa_, isa_;
+  detail::wavelet::matrix wavelet_;
+};
+
+}  // fm
+}  // sort
+
+#endif  // SORT_FM_H
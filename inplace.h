@@ -33,11 +33,13 @@
 #include <climits>
 #include <cmath>
 #include <cstdint>
+#include <iterator>
 #include <tuple>
 #include <type_traits>
 
 #include "detail/misc.h"
 #include "detail/inplace.h"
+#include "detail/sample.h"
 
 namespace sort {
 namespace inplace {
@@ -82,6 +84,70 @@ inline void block(T first, T last, I index) {
   }, budget);
 }
 
+// In-place super scalar samplesort
+// Distributes into up to 256 buckets (plus equality buckets for splitters
+// occuring multiple times) with a branchless search tree and a block based
+// in-place permutation, so big ranges are moved log256(n) rather than
+// log3(n) times. Small ranges are handed to block() for arithmetic keys
+// and to quick() otherwise.
+// Same index function and equal range callbacks as quick()
+template <int LR = detail::misc::LR, class T, class I, class C>
+inline void sample(T first, T last, I index, C cb) {
+  using W = typename std::iterator_traits<T>::value_type;
+  using V = std::remove_reference_t<decltype(index(*first))>;
+  detail::sample::buffers<W, V> buf(detail::sample::block<W>());
+  int budget = detail::misc::ilogb(last - first + 1);
+  detail::sample::sort<LR, std::is_arithmetic<V>::value>(first, last, index, cb, buf, budget);
+}
+
+template <int LR = detail::misc::LR, class T, class I>
+inline void sample(T first, T last, I index) {
+  sort::inplace::sample<detail::misc::NOCB>(first, last, index, [](auto a, auto b) {
+    (void) a; (void) b;
+  });
+}
+
+// Multithreaded samplesort (no callbacks as buckets finish out of order)
+// threads = 0 uses one thread per hardware thread, needs -pthread
+template <class T, class I>
+inline void parallel_sample(T first, T last, I index, unsigned threads = 0) {
+  detail::sample::parallel(first, last, index, threads);
+}
+
+// Three pivot quickselect (introselect)
+// Rearranges [first, last) so *nth is the element a full sort would put
+// there, everything before is not greater and everything after not smaller.
+// Expected runtime is O(n), worst case O(n * log(n))
+template <class T, class I>
+inline void select(T first, T nth, T last, I index) {
+  int budget = 2 * detail::misc::ilogb(last - first + 1);
+  detail::inplace::select<0>(first, nth, last, index, budget);
+}
+
+// Sorts [first, middle) to hold the smallest elements of [first, last)
+// the order of [middle, last) is unspecified. Equal range callbacks only
+// cover [first, middle) so a range might be cut at middle.
+template <int LR = detail::misc::LR, class T, class I, class C>
+inline void partial_sort(T first, T middle, T last, I index, C cb) {
+  sort::inplace::select(first, middle, last, index);
+  sort::inplace::quick<LR>(first, middle, index, cb);
+}
+
+template <int LR = detail::misc::LR, class T, class I>
+inline void partial_sort(T first, T middle, T last, I index) {
+  sort::inplace::select(first, middle, last, index);
+  sort::inplace::quick<LR>(first, middle, index);
+}
+
+// Moves the k smallest elements to [first, first + k) in no particular
+// order and returns first + k (k is clamped to [0, last - first])
+template <class T, class I>
+inline T top_k(T first, T last, std::ptrdiff_t k, I index) {
+  auto middle = first + std::max<std::ptrdiff_t>(0, std::min<std::ptrdiff_t>(k, std::distance(first, last)));
+  sort::inplace::select(first, middle, last, index);
+  return middle;
+}
+
 }  // inplace
 }  // sort
 
@@ -0,0 +1,87 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Structure of Arrays Key/Value Sort
+//  sorts a key column and moves a value column in lockstep
+//  without interleaving them into pairs first
+
+#ifndef SORT_KEY_H
+#define SORT_KEY_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <iterator>
+#include <type_traits>
+
+#include "detail/misc.h"
+#include "detail/zip.h"
+#include "inplace.h"
+
+namespace sort {
+
+// Sort [kf, kl) and apply the same permutation to [vf, vf + (kl - kf))
+// Cheap (arithmetic) keys use the branchless block partitioner,
+// everything else the three pivot quicksort to save comparisons.
+// cb(a, b) is called on every range [a, b) of equal keys in LR order
+template <int LR = detail::misc::LR, class K, class V, class C>
+inline void sort_by_key(K kf, K kl, V vf, C cb) {
+  auto first = detail::zip::make(kf, vf);
+  auto last = first + std::distance(kf, kl);
+  auto key = [](const auto &a) { return a.first; };
+  auto kcb = [cb](auto a, auto b) { cb(a.key(), b.key()); };
+
+  using W = typename std::iterator_traits<K>::value_type;
+  if (std::is_arithmetic<W>::value)
+    sort::inplace::block<LR>(first, last, key, kcb);
+  else
+    sort::inplace::quick<LR>(first, last, key, kcb);
+}
+
+template <int LR = detail::misc::LR, class K, class V>
+inline void sort_by_key(K kf, K kl, V vf) {
+  auto first = detail::zip::make(kf, vf);
+  auto last = first + std::distance(kf, kl);
+  auto key = [](const auto &a) { return a.first; };
+
+  using W = typename std::iterator_traits<K>::value_type;
+  if (std::is_arithmetic<W>::value)
+    sort::inplace::block<LR>(first, last, key);
+  else
+    sort::inplace::quick<LR>(first, last, key);
+}
+
+// Key only fast path: no value column to drag along so every swap
+// and comparison works on plain keys the compiler can vectorize
+template <int LR = detail::misc::LR, class K>
+inline void sort_by_key(K kf, K kl) {
+  auto key = [](const auto &a) { return a; };
+
+  using W = typename std::iterator_traits<K>::value_type;
+  if (std::is_arithmetic<W>::value)
+    sort::inplace::block<LR>(kf, kl, key);
+  else
+    sort::inplace::quick<LR>(kf, kl, key);
+}
+
+}  // sort
+
+#endif  // SORT_KEY_H
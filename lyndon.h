@@ -0,0 +1,167 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Lyndon Structure
+//  the Lyndon array of a text (the longest Lyndon word starting at each
+//  position, i.e. the distance to the next smaller suffix) from the ISA
+//  daware leaves behind, the bijective BWT and the runs (maximal
+//  repetitions) of a text
+
+#ifndef SORT_LYNDON_H
+#define SORT_LYNDON_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "detail/lyndon.h"
+#include "suffix.h"
+
+namespace sort {
+namespace lyndon {
+
+// Lyndon array of a text of n symbols from its ISA (n + 1 elements as
+// computed by sort::suffix::build, ISA[n] == 0 is the sentinel)
+// L[i] is the length of the longest Lyndon word starting at i which ends
+// right before the next smaller suffix (NSV of ISA): i + L[i]
+// Right to left every position jumps along the Lyndon words following it
+// until it hits a smaller suffix. A word jumped over is never looked at
+// again by a position left of it so this is O(n) and needs no extra memory.
+template <class U, class L>
+void array(U ISAf, std::ptrdiff_t n, L Lf) {
+  using W = std::remove_reference_t<decltype(*Lf)>;
+  for (auto i = n - 1; i >= 0; --i) {
+    auto j = i + 1;
+    while (ISAf[i] < ISAf[j]) j += static_cast<std::ptrdiff_t>(Lf[j]);
+    Lf[i] = static_cast<W>(j - i);
+  }
+}
+
+// Lyndon array of the integer text [Tf, Tl) with symbols in [0, sigma)
+// A suffix running out is smaller than every extension of it
+// [Lf, Lf + n) receives the lengths, X is the index type of SA and ISA
+template <class X = std::int32_t, class S, class L>
+void array(S Tf, S Tl, std::size_t sigma, L Lf) {
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  std::vector<X> ISA(n + 1);
+  {
+    std::vector<X> SA(n + 1);
+#ifdef USE_COPY
+    std::vector<X> A(n + 1);
+    sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+#else
+    sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin());
+#endif
+  }
+  lyndon::array(ISA.begin(), n, Lf);
+}
+
+// Runs (maximal repetitions) of the integer text [Tf, Tl) with symbols in
+// [0, sigma): f(start, length, period) is called once for every run, a
+// substring of length >= 2 * period with smallest period period that can't
+// be extended. Uses the characterization by Lyndon roots (Bannai, I,
+// Inenaga, Nakashima, Takeda, Tsuruta): every run contains a longest
+// Lyndon word as its period under one of the two orders of the alphabet
+// so the Lyndon array is built for both and every root checked with
+// amortized O(1) longest common extensions (see detail::lyndon::runs),
+// O(n) overall.
+// SA, ISA (n + 1) and the scratch space of build() hold both suffix
+// arrays in turn and the Lyndon array of the text replaces SA. The one
+// of the reversed order is allocated besides, so is the LCP table of
+// detail::lyndon::lce once the extensions get long.
+// Runs are reported in no particular order.
+#ifdef USE_COPY
+template <class S, class T, class U, class V, class F>
+void runs(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf, V Af, V Al, F f) {
+#else
+template <class S, class T, class U, class F>
+void runs(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf, F f) {
+#endif
+  using X = std::remove_reference_t<decltype(*ISAf)>;
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  if (n < 2) return;
+
+  // Lyndon array under the reversed order first, the ISA of the text
+  // is kept for the longest common extensions
+  std::vector<X> R(n);
+  detail::lyndon::reversed<S> Rf(Tf, sigma), Rl(Tl, sigma);
+#ifdef USE_COPY
+  sort::suffix::build(Rf, Rl, sigma, SAf, ISAf, Af, Al);
+  lyndon::array(ISAf, n, R.begin());
+  sort::suffix::build(Tf, Tl, sigma, SAf, ISAf, Af, Al);
+#else
+  sort::suffix::build(Rf, Rl, sigma, SAf, ISAf);
+  lyndon::array(ISAf, n, R.begin());
+  sort::suffix::build(Tf, Tl, sigma, SAf, ISAf);
+#endif
+  lyndon::array(ISAf, n, SAf);
+  detail::lyndon::lce<S, U> lce(Tf, n, ISAf);
+  detail::lyndon::runs(Tf, n, false, SAf, lce, f);
+  detail::lyndon::runs(Tf, n, true, R.begin(), lce, f);
+}
+
+// Bijective BWT of [Tf, Tl) into [Of, Of + n), no primary index needed
+// All conjugates of the Lyndon factors of the text are sorted by the order
+// of their infinite repetitions (see detail::lyndon::conjugates) and the
+// output holds the symbol preceding each one (cyclically in its factor).
+// The factors are the chain of Lyndon words from 0, the conjugates are
+// induced from the suffix array and the Lyndon array of build().
+// X is the index type, needs 5 * n of them
+template <class X = std::int32_t, class S, class O>
+void bbwt(S Tf, S Tl, O Of) {
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  if (n == 0) return;
+
+  std::size_t sigma = 0;
+  for (auto it = Tf; it != Tl; ++it) sigma = std::max(sigma, detail::suffix::symbol(it) + 1);
+  std::vector<X> SA(n + 1), ISA(n + 1), L(n + 1);
+#ifdef USE_COPY
+  sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin(), L.begin(), L.end());
+#else
+  sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin());
+#endif
+  lyndon::array(ISA.begin(), n, L.begin());
+
+  std::vector<X> N(n);
+  for (std::ptrdiff_t s = 0, e; s < n; s = e) {
+    e = s + L[s];
+    for (auto p = s; p < e; ++p) N[p] = static_cast<X>(p + L[p] == e ? s : p + L[p]);
+  }
+  std::vector<detail::misc::pair<X, X>> P(n / 2 + 1);
+  detail::lyndon::conjugates(Tf, n, SA.begin(), ISA.begin(), L.begin(), N.begin(), P.data(),
+                             P.data() + P.size());
+  for (std::ptrdiff_t r = 0; r < n; ++r) {
+    std::ptrdiff_t p = SA[r + 1];
+    if (p > 0) Of[r] = Tf[p - 1];
+  }
+  for (std::ptrdiff_t s = 0; s < n; s += L[s]) Of[ISA[s] - 1] = Tf[s + L[s] - 1];
+}
+
+}  // lyndon
+}  // sort
+
+#endif  // SORT_LYNDON_H
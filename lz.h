@@ -0,0 +1,94 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// LZ77 Factorization
+//  the greedy LZ77 parse of a text streamed straight from its suffix
+//  array, reusing the buffers of the construction for PSV and NSV
+
+#ifndef SORT_LZ_H
+#define SORT_LZ_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "detail/lz.h"
+#include "suffix.h"
+
+namespace sort {
+namespace lz {
+
+// Greedy LZ77 parse of [Tf, Tl) given its suffix array (the n + 1 rows
+// of sort::suffix::build, sentinel first): f(source, length) is called for
+// every factor left to right, a symbol without previous occurence as
+// f(symbol, 0) (see detail::lz::parse). The ISA isn't needed anymore
+// so its buffer receives the PSV and the scratch space of build() the NSV
+// (see detail::lz::neighbours), only if the scratch holds less than n
+// elements a buffer is allocated for it. SA is left untouched.
+#ifdef USE_COPY
+template <class S, class T, class U, class V, class F>
+void factorize(S Tf, S Tl, T SAf, U ISAf, V Af, V Al, F f) {
+#else
+template <class S, class T, class U, class F>
+void factorize(S Tf, S Tl, T SAf, U ISAf, F f) {
+#endif
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  if (n == 0) return;
+
+#ifdef USE_COPY
+  if (std::distance(Af, Al) >= n) {
+    detail::lz::neighbours(SAf, n + 1, n, ISAf, Af);
+    detail::lz::parse(Tf, n, ISAf, Af, f);
+    return;
+  }
+#endif
+  std::vector<std::remove_reference_t<decltype(*ISAf)>> N(n);
+  detail::lz::neighbours(SAf, n + 1, n, ISAf, N.begin());
+  detail::lz::parse(Tf, n, ISAf, N.begin(), f);
+}
+
+// Greedy LZ77 parse of the integer text [Tf, Tl) with symbols in [0, sigma)
+// Builds the suffix array first, X is its index type. Needs 3 * (n + 1)
+// of them in total (SA, ISA and scratch space) and nothing on top.
+template <class X = std::int32_t, class S, class F>
+void factorize(S Tf, S Tl, std::size_t sigma, F f) {
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  std::vector<X> SA(n + 1), ISA(n + 1);
+#ifdef USE_COPY
+  std::vector<X> A(n + 1);
+  sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+  lz::factorize(Tf, Tl, SA.begin(), ISA.begin(), A.begin(), A.end(), f);
+#else
+  sort::suffix::build(Tf, Tl, sigma, SA.begin(), ISA.begin());
+  lz::factorize(Tf, Tl, SA.begin(), ISA.begin(), f);
+#endif
+}
+
+}  // lz
+}  // sort
+
+#endif  // SORT_LZ_H
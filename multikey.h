@@ -0,0 +1,127 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Multikey String Quicksort
+//  sorts strings by their characters and reports the longest common
+//  prefix of every pair of neighbours in the output
+
+#ifndef SORT_MULTIKEY_H
+#define SORT_MULTIKEY_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include "detail/misc.h"
+#include "detail/zip.h"
+#include "inplace.h"
+
+namespace sort {
+namespace strings {
+
+// Sorts [first, last) and writes LCP(first[i - 1], first[i]) to lcp[i]
+// (lcp[0] = 0). get_char(s, d) returns the d-th character of s as a value
+// in [0, 256) with 0 marking the end of s (like a C string).
+// Eight characters are packed into a 64 bit word which is cached for the
+// whole range and sorted with block(). Every range of equal words is
+// pushed onto a stack and sorted again at depth + 8 unless its strings end
+// within the word. The LCP of two neighbours is known as soon as their
+// words differ so every entry of lcp is written exactly once.
+template <class T, class G, class L>
+inline void multikey(T first, T last, G get_char, L lcp) {
+  auto n = std::distance(first, last);
+  if (n <= 0) return;
+  lcp[0] = 0;
+
+  // Length of the common prefix of two words (bytes) / of the string in w
+  // (highest differing bit / lowest set bit, see detail::misc::ilogb)
+  auto common = [](std::uint64_t a, std::uint64_t b) {
+    return a == b ? 8 : (63 - detail::misc::ilogb(a ^ b)) / 8;
+  };
+  auto length = [](std::uint64_t w) {
+    return w ? 8 - detail::misc::ilogb(w & (~w + 1)) / 8 : 0;
+  };
+
+  std::vector<std::uint64_t> words(n);
+  std::vector<std::tuple<std::ptrdiff_t, std::ptrdiff_t, std::ptrdiff_t>> stack;
+  stack.emplace_back(0, n, 0);
+
+  while (!stack.empty()) {
+    std::ptrdiff_t lo, hi, depth;
+    std::tie(lo, hi, depth) = stack.back();
+    stack.pop_back();
+
+    // Cache the next eight characters of every string
+    for (auto i = lo; i < hi; ++i) {
+      std::uint64_t w = 0;
+      int j = 0;
+      for (; j < 8; ++j) {
+        std::uint64_t c = static_cast<unsigned char>(get_char(first[i], depth + j));
+        w = w << 8 | c;
+        if (c == 0) break;
+      }
+      words[i] = j < 8 ? w << (8 * (7 - j)) : w;
+    }
+
+    auto z = detail::zip::make(words.begin(), first);
+    auto prev = z + lo;
+    sort::inplace::block(z + lo, z + hi, [](const auto &a) { return a.first; }, [&](auto a, auto b) {
+      auto i = a - z, j = b - z;
+      if (i != lo) lcp[i] = depth + common(*prev.key(), *a.key());
+      prev = a;
+      if (j - i < 2) return;
+
+      auto w = *a.key();
+      if (w & 0xFF) {
+        stack.emplace_back(i, j, depth + 8);
+      } else {
+        // All strings of the range ended - they are equal
+        for (auto k = i + 1; k < j; ++k) lcp[k] = depth + length(w);
+      }
+    });
+  }
+}
+
+// Same as above but returns the LCP array
+template <class T, class G>
+inline std::vector<std::ptrdiff_t> multikey(T first, T last, G get_char) {
+  std::vector<std::ptrdiff_t> lcp(std::distance(first, last));
+  sort::strings::multikey(first, last, get_char, lcp.begin());
+  return lcp;
+}
+
+// Null terminated strings (const char*, const unsigned char*, ...)
+template <class T>
+inline std::vector<std::ptrdiff_t> multikey(T first, T last) {
+  return sort::strings::multikey(first, last, [](const auto &s, std::ptrdiff_t d) {
+    return s[d];
+  });
+}
+
+}  // strings
+}  // sort
+
+#endif  // SORT_MULTIKEY_H
@@ -0,0 +1,157 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Huge Page Buffers
+//  SA, ISA and scratch storage backed by 1 GB / 2 MB pages where the
+//  system provides them - daware's ISA[SA[i] + depth] lookups span the
+//  whole array so most misses on big inputs are dTLB misses
+
+#ifndef SORT_PAGES_H
+#define SORT_PAGES_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace sort {
+namespace memory {
+
+// What a buffer got, best first
+enum class backing { hugetlb_1g, hugetlb_2m, transparent, normal };
+
+inline const char* name(memory::backing b) {
+  switch (b) {
+    case backing::hugetlb_1g:  return "hugetlb 1 GB";
+    case backing::hugetlb_2m:  return "hugetlb 2 MB";
+    case backing::transparent: return "transparent huge pages";
+    default:                   return "normal pages";
+  }
+}
+
+// Fixed size uninitialized array of n trivial elements (SA, ISA, ...)
+// Tries explicit hugetlb pages (reserved via vm.nr_hugepages) first, then
+// 2 MB aligned memory with madvise(MADV_HUGEPAGE) and finally plain
+// malloc. Ranges below 2 MB always use malloc. Throws std::bad_alloc if
+// there is no memory at all.
+template <class T> class buffer {
+  static_assert(std::is_trivial<T>::value, "buffer holds trivial types only");
+
+ public:
+  static constexpr std::size_t PAGE_2M = std::size_t(1) << 21;
+  static constexpr std::size_t PAGE_1G = std::size_t(1) << 30;
+
+  buffer() = default;
+  explicit buffer(std::size_t n, bool huge = true) : size_(n) {
+    auto bytes = n * sizeof(T);
+#ifdef __linux__
+    if (huge && bytes >= PAGE_2M) {
+      // Explicit pages - 1 GB ones only if at least one is filled completely
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_1GB)
+      if (bytes >= PAGE_1G && map(bytes, PAGE_1G, MAP_HUGETLB | MAP_HUGE_1GB))
+        return (void) (backing_ = backing::hugetlb_1g);
+#endif
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_2MB)
+      if (map(bytes, PAGE_2M, MAP_HUGETLB | MAP_HUGE_2MB))
+        return (void) (backing_ = backing::hugetlb_2m);
+#endif
+
+      // Transparent huge pages need 2 MB aligned ranges
+      void* p = nullptr;
+      if (posix_memalign(&p, PAGE_2M, round(bytes, PAGE_2M)) == 0) {
+        data_ = static_cast<T*>(p);
+#ifdef MADV_HUGEPAGE
+        if (madvise(p, round(bytes, PAGE_2M), MADV_HUGEPAGE) == 0)
+          backing_ = backing::transparent;
+#endif
+        return;
+      }
+    }
+#else
+    (void) huge;
+#endif
+    data_ = static_cast<T*>(std::malloc(bytes ? bytes : 1));
+    if (data_ == nullptr) throw std::bad_alloc();
+  }
+
+  buffer(const buffer&) = delete;
+  buffer& operator=(const buffer&) = delete;
+  buffer(buffer&& rhs) noexcept { swap(rhs); }
+  buffer& operator=(buffer&& rhs) noexcept { swap(rhs); return *this; }
+  ~buffer() { release(); }
+
+  T* data() const { return data_; }
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+  std::size_t size() const { return size_; }
+  T& operator[](std::size_t i) { return data_[i]; }
+  const T& operator[](std::size_t i) const { return data_[i]; }
+
+  memory::backing backing() const { return backing_; }
+
+ private:
+  static std::size_t round(std::size_t v, std::size_t page) {
+    return (v + page - 1) / page * page;
+  }
+
+#ifdef __linux__
+  bool map(std::size_t bytes, std::size_t page, int flags) {
+    auto length = round(bytes, page);
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<T*>(p);
+    mapped_ = length;
+    return true;
+  }
+#endif
+
+  void release() {
+#ifdef __linux__
+    if (mapped_) return (void) munmap(data_, mapped_);
+#endif
+    std::free(data_);
+  }
+
+  void swap(buffer& rhs) {
+    std::swap(data_, rhs.data_);
+    std::swap(size_, rhs.size_);
+    std::swap(mapped_, rhs.mapped_);
+    std::swap(backing_, rhs.backing_);
+  }
+
+  T* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t mapped_ = 0;  // length of the mapping for hugetlb pages
+  memory::backing backing_ = backing::normal;
+};
+
+}  // memory
+}  // sort
+
+#endif  // SORT_PAGES_H
@@ -0,0 +1,220 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Pattern Query Engine
+//  answers count and locate queries of many patterns at once on a suffix
+//  array: mlr binary search started from a lookup table, interleaved
+//  with prefetching across queries and sharded over a thread pool
+
+#ifndef SORT_QUERY_H
+#define SORT_QUERY_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "detail/misc.h"
+#include "detail/query.h"
+#include "detail/suffix.h"
+#include "detail/thread.h"
+
+namespace sort {
+namespace query {
+
+// Queries on the text [Tf, Tl) and its suffix array [SAf, SAl), either the
+// n + 1 rows of sort::suffix::build (sentinel first) or just the n suffixes.
+// Both are referenced, not copied, must outlive the engine and be
+// contiguous (pointers or vector iterators) as they are prefetched.
+// The first jump of every search comes from a table of the rows of every
+// string of q symbols (q is lowered until sigma^q <= BUCKET_MAX) so the
+// search starts inside the rows sharing the first q symbols. From there mlr
+// (Manber, Myers) skips the prefix shared with both ends of the range which
+// makes the LCP array unnecessary for the short patterns this is meant for.
+// Batches are split into QUERY_SHARD patterns per job and every job
+// searches QUERY_GROUP of them in lockstep (see detail::query::search).
+// Patterns are ranges (std::begin / std::end) of symbols like the text.
+template <class S, class T> class engine {
+ public:
+  using range = std::pair<std::size_t, std::size_t>;
+
+  // threads = 0 uses one thread per hardware thread
+  engine(S Tf, S Tl, T SAf, T SAl, std::size_t q = 2, unsigned threads = 0)
+      : text_(Tf), sa_(SAf), n_(std::distance(Tf, Tl)), rows_(std::distance(SAf, SAl)), pool_(threads) {
+    for (auto it = Tf; it != Tl; ++it) sigma_ = std::max(sigma_, detail::suffix::symbol(it) + 1);
+    for (std::size_t codes; q > 0; --q) {
+      codes = 1;
+      for (std::size_t j = 0; j < q && codes <= detail::misc::BUCKET_MAX; ++j) codes *= sigma_;
+      if (codes <= detail::misc::BUCKET_MAX) break;
+    }
+
+    // Rows of every string of q symbols, searched in batches like queries
+    // (q_ is still 0 so they start from all rows). A bucket needs both ends:
+    // the suffixes shorter than q fall in between two of them
+    std::size_t codes = 1;
+    for (std::size_t j = 0; j < q; ++j) codes *= sigma_;
+    std::vector<std::size_t> buf(codes * q);
+    for (std::size_t c = 0; c < codes; ++c)
+      for (auto j = q, x = c; j-- > 0; x /= sigma_) buf[c * q + j] = x % sigma_;
+    table_.resize(codes);
+    shard(codes, [this, &buf, q](std::size_t b, std::size_t k) {
+      std::array<const std::size_t*, detail::misc::QUERY_GROUP> pf;
+      std::array<std::ptrdiff_t, detail::misc::QUERY_GROUP> m;
+      for (std::size_t i = 0; i < k; ++i) {
+        pf[i] = buf.data() + (b + i) * q;
+        m[i] = static_cast<std::ptrdiff_t>(q);
+      }
+      lookup(pf.data(), m.data(), k, table_.data() + b);
+    });
+    q_ = static_cast<std::ptrdiff_t>(q);
+  }
+
+  std::size_t size() const { return static_cast<std::size_t>(n_); }
+  unsigned threads() const { return pool_.size(); }
+
+  // Rows [first, second) of the suffixes starting with [Pf, Pl)
+  template <class P> range find(P Pf, P Pl) const {
+    range r;
+    std::ptrdiff_t m = std::distance(Pf, Pl);
+    lookup(&Pf, &m, 1, &r);
+    return r;
+  }
+
+  // Number of occurences of [Pf, Pl)
+  template <class P> std::size_t count(P Pf, P Pl) const {
+    auto r = find(Pf, Pl);
+    return r.second - r.first;
+  }
+
+  // out[i] = find() of the i-th pattern in [first, last)
+  template <class R, class O> void find(R first, R last, O out) {
+    batch(first, last, [out](std::size_t i, range r) { out[i] = r; });
+  }
+
+  // out[i] = count() of the i-th pattern in [first, last)
+  template <class R, class O> void count(R first, R last, O out) {
+    batch(first, last, [out](std::size_t i, range r) { out[i] = r.second - r.first; });
+  }
+
+  // Text positions of all occurences of the patterns in [first, last)
+  // Those of the i-th pattern go to [out + bounds[i], out + bounds[i + 1])
+  // in SA order, bounds needs one element more than there are patterns.
+  // Returns the total number of occurences.
+  template <class R, class B, class O> std::size_t locate(R first, R last, B bounds, O out) {
+    auto m = static_cast<std::size_t>(std::distance(first, last));
+    std::vector<range> ranges(m);
+    find(first, last, ranges.begin());
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < m; ++i) {
+      bounds[i] = total;
+      total += ranges[i].second - ranges[i].first;
+    }
+    bounds[m] = total;
+
+    shard(m, [this, &ranges, bounds, out](std::size_t b, std::size_t k) {
+      for (auto i = b; i < b + k; ++i)
+        std::copy(sa_ + ranges[i].first, sa_ + ranges[i].second, out + bounds[i]);
+    });
+    return total;
+  }
+
+ private:
+  // Call f(b, k) for the groups [b, b + k) of [0, m) on the thread pool
+  template <class F> void shard(std::size_t m, F f) {
+    const std::size_t G = detail::misc::QUERY_GROUP, J = detail::misc::QUERY_SHARD;
+    pool_.run((m + J - 1) / J, [m, &f, G, J](unsigned, std::size_t j) {
+      for (auto b = j * J, e = std::min(m, b + J); b < e; b += G) f(b, std::min(G, e - b));
+    });
+  }
+
+  // f(i, find()) for the i-th pattern in [first, last)
+  template <class R, class F> void batch(R first, R last, F f) {
+    using P = decltype(std::begin(*first));
+    auto m = static_cast<std::size_t>(std::distance(first, last));
+    shard(m, [this, first, &f](std::size_t b, std::size_t k) {
+      std::array<P, detail::misc::QUERY_GROUP> pf;
+      std::array<std::ptrdiff_t, detail::misc::QUERY_GROUP> len;
+      std::array<range, detail::misc::QUERY_GROUP> r;
+      len.fill(0);
+      for (std::size_t i = 0; i < k; ++i) {
+        auto&& p = first[b + i];
+        pf[i] = std::begin(p);
+        len[i] = std::distance(pf[i], std::end(p));
+      }
+      lookup(pf.data(), len.data(), k, r.data());
+      for (std::size_t i = 0; i < k; ++i) f(b + i, r[i]);
+    });
+  }
+
+  // Rows of the k <= QUERY_GROUP patterns [pf[i], pf[i] + m[i]) into out
+  // A lower bound search finds the first row, an upper bound search started
+  // from there up to the end of the same bucket the end
+  template <class P, class O>
+  void lookup(const P* pf, const std::ptrdiff_t* m, std::size_t k, O out) const {
+    std::array<detail::query::state, detail::misc::QUERY_GROUP> st;
+    std::array<detail::query::state, detail::misc::QUERY_GROUP> init;
+    for (std::size_t i = 0; i < k; ++i) st[i] = init[i] = start(pf[i], m[i]);
+    detail::query::search(text_, n_, sa_, pf, m, st.data(), k, false);
+    for (std::size_t i = 0; i < k; ++i) {
+      out[i].first = static_cast<std::size_t>(st[i].lo);
+      init[i].lo = st[i].lo;
+      st[i] = init[i];
+    }
+    detail::query::search(text_, n_, sa_, pf, m, st.data(), k, true);
+    for (std::size_t i = 0; i < k; ++i) out[i].second = static_cast<std::size_t>(st[i].lo);
+  }
+
+  // Initial range of a search: the rows starting with the first q symbols
+  // of the pattern, all of them if it's shorter or has symbols out of the text
+  template <class P> detail::query::state start(P pf, std::ptrdiff_t m) const {
+    detail::query::state s{0, rows_, 0, 0, 0, 0};
+    if (q_ == 0 || m < q_) return s;
+    std::size_t code = 0;
+    for (std::ptrdiff_t j = 0; j < q_; ++j) {
+      auto c = detail::suffix::symbol(pf + j);
+      if (c >= sigma_) return s;
+      code = code * sigma_ + c;
+    }
+    s.lo = static_cast<std::ptrdiff_t>(table_[code].first);
+    s.hi = static_cast<std::ptrdiff_t>(table_[code].second);
+    s.l = s.r = q_;
+    return s;
+  }
+
+  S text_;
+  T sa_;
+  std::ptrdiff_t n_, rows_, q_ = 0;
+  std::size_t sigma_ = 1;
+  std::vector<range> table_;
+  detail::thread::pool pool_;
+};
+
+}  // query
+}  // sort
+
+#endif  // SORT_QUERY_H
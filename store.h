@@ -0,0 +1,354 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// On-Disk Suffix Arrays
+//  a versioned container for SA, ISA, LCP and BWT which is written as a
+//  stream and read through mmap without copying or parsing anything
+
+#ifndef SORT_STORE_H
+#define SORT_STORE_H
+
+#ifdef __INTEL_COMPILER
+#pragma warning disable 3373
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SORT_STORE_MMAP
+#endif
+
+namespace sort {
+namespace store {
+
+// Layout (native byte order, checked by the endian marker):
+//   [0, 4096)  header followed by the section table
+//   sections   each starting at a multiple of 4096 so every view is aligned
+// Checksums are FNV-1a over 64 bit words (the tail zero padded)
+constexpr const std::uint64_t MAGIC   = 0x3130415741574144ull;  // "DAWARA01"
+constexpr const std::uint32_t VERSION = 1;
+constexpr const std::uint32_t ENDIAN  = 0x01020304;
+constexpr const std::size_t   PAGE    = 4096;
+
+enum kind : std::uint32_t { SA = 1, ISA = 2, LCP = 3, BWT = 4 };
+
+struct section {
+  std::uint32_t kind;
+  std::uint32_t width;   // bytes per element
+  std::uint64_t offset;  // from the start of the file
+  std::uint64_t count;   // elements
+  std::uint64_t checksum;
+};
+
+struct header {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t endian;
+  std::uint64_t n;          // text length
+  std::uint64_t text;       // hash of the text
+  std::uint32_t width;      // index width of the builder (4 or 8)
+  std::uint32_t sections;
+  std::uint64_t reserved[3];
+};
+
+constexpr const std::size_t MAX_SECTIONS = (PAGE - sizeof(header)) / sizeof(section);
+
+// Running FNV-1a over 64 bit words
+class checksum {
+ public:
+  void update(const void* data, std::size_t size) {
+    auto p = static_cast<const unsigned char*>(data);
+    for (; size; --size) {
+      word_ |= std::uint64_t(*p++) << (8 * fill_);
+      if (++fill_ == 8) flush();
+    }
+  }
+
+  std::uint64_t value() {
+    if (fill_) flush();
+    return h_;
+  }
+
+ private:
+  void flush() {
+    h_ = (h_ ^ word_) * 0x100000001b3ull;
+    word_ = 0;
+    fill_ = 0;
+  }
+
+  std::uint64_t h_ = 0xcbf29ce484222325ull, word_ = 0;
+  int fill_ = 0;
+};
+
+// Hash of a text to tie the arrays to the text they were built from
+template <class S> inline std::uint64_t hash(S first, S last) {
+  checksum h;
+  for (; first != last; ++first) {
+    auto c = *first;
+    h.update(&c, sizeof(c));
+  }
+  return h.value();
+}
+
+// Streaming writer: begin() a section, write() its elements in as many
+// pieces as needed (converted to the section width of 1, 2, 4 or 8 bytes)
+// and end() it. Sections don't nest: begin() fails while one is open,
+// write() and end() (and close()) fail unless exactly one is.
+// close() writes the header, all calls return false on I/O errors.
+// The SA section can be written from daware's emit callback as it hands
+// out the final ranges left to right
+class writer {
+ public:
+  writer(const char* path, std::uint64_t n, std::uint64_t text, std::uint32_t width)
+      : file_(std::fopen(path, "wb")) {
+    std::memset(&header_, 0, sizeof(header_));
+    header_.magic = MAGIC;
+    header_.version = VERSION;
+    header_.endian = ENDIAN;
+    header_.n = n;
+    header_.text = text;
+    header_.width = width;
+    ok_ = file_ && pad(PAGE);
+  }
+
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+  ~writer() { if (file_) close(); }
+
+  explicit operator bool() const { return ok_; }
+
+  bool begin(std::uint32_t kind, std::uint32_t width) {
+    if (!ok_ || open_ || header_.sections == MAX_SECTIONS || (width != 1 && width != 2 && width != 4 && width != 8))
+      return ok_ = false;
+    ok_ = pad((pos_ + PAGE - 1) / PAGE * PAGE);
+    current_ = section{kind, width, pos_, 0, 0};
+    sum_ = checksum();
+    open_ = ok_;
+    return ok_;
+  }
+
+  template <class I> bool write(I first, I last) {
+    if (!open_) return ok_ = false;
+    unsigned char buf[8 * 1024];
+    std::size_t fill = 0, w = current_.width;
+    for (; ok_ && first != last; ++first) {
+      auto v = static_cast<std::uint64_t>(*first);
+      if (w < 8 && (v >> (8 * w)) != 0) return ok_ = false;  // doesn't fit
+      store(buf + fill, v, w);
+      if ((fill += w) + w > sizeof(buf)) ok_ = put(buf, fill), fill = 0;
+    }
+    if (ok_ && fill) ok_ = put(buf, fill);
+    return ok_;
+  }
+
+  bool end() {
+    if (!ok_ || !open_) return ok_ = false;
+    open_ = false;
+    current_.count = (pos_ - current_.offset) / current_.width;
+    current_.checksum = sum_.value();
+    sections_[header_.sections++] = current_;
+    return true;
+  }
+
+  bool close() {
+    if (open_) ok_ = false;
+    if (ok_) {
+      ok_ = std::fseek(file_, 0, SEEK_SET) == 0
+          && std::fwrite(&header_, sizeof(header_), 1, file_) == 1
+          && std::fwrite(sections_, sizeof(section), header_.sections, file_) == header_.sections;
+    }
+    if (file_ && std::fclose(file_) != 0) ok_ = false;
+    file_ = nullptr;
+    return ok_;
+  }
+
+ private:
+  bool put(const void* data, std::size_t size) {
+    sum_.update(data, size);
+    pos_ += size;
+    return std::fwrite(data, 1, size, file_) == size;
+  }
+
+  // Native representation of an unsigned integer of w bytes
+  static void store(unsigned char* p, std::uint64_t v, std::size_t w) {
+    auto v8 = static_cast<std::uint8_t>(v);
+    auto v16 = static_cast<std::uint16_t>(v);
+    auto v32 = static_cast<std::uint32_t>(v);
+    if (w == 1) std::memcpy(p, &v8, 1);
+    else if (w == 2) std::memcpy(p, &v16, 2);
+    else if (w == 4) std::memcpy(p, &v32, 4);
+    else std::memcpy(p, &v, 8);
+  }
+
+  bool pad(std::uint64_t to) {
+    static const unsigned char zeros[PAGE] = {};
+    while (pos_ < to) {
+      auto k = static_cast<std::size_t>(std::min<std::uint64_t>(to - pos_, PAGE));
+      if (std::fwrite(zeros, 1, k, file_) != k) return false;
+      pos_ += k;
+    }
+    return true;
+  }
+
+  std::FILE* file_;
+  bool ok_ = false;
+  bool open_ = false;  // between begin() and end()
+  std::uint64_t pos_ = 0;
+  header header_;
+  section sections_[MAX_SECTIONS];
+  section current_{};
+  checksum sum_;
+};
+
+// Typed read only view into a mapped section
+template <class X> struct view {
+  const X* data = nullptr;
+  std::size_t size = 0;
+
+  const X* begin() const { return data; }
+  const X* end() const { return data + size; }
+  const X& operator[](std::size_t i) const { return data[i]; }
+  explicit operator bool() const { return data != nullptr; }
+};
+
+// Maps a file written by writer. Opening only checks the header, the
+// sections are paged in on first use and shared with every other process
+// mapping the same file. verify() reads everything to check the checksums
+class reader {
+ public:
+  reader() = default;
+  explicit reader(const char* path) { open(path); }
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+  ~reader() { close(); }
+
+  bool open(const char* path) {
+    close();
+#ifdef SORT_STORE_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= PAGE) {
+      size_ = static_cast<std::size_t>(st.st_size);
+      void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      base_ = p == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(p);
+    }
+    ::close(fd);
+#else
+    // No mmap: fall back to reading the file
+    if (auto f = std::fopen(path, "rb")) {
+      std::fseek(f, 0, SEEK_END);
+      size_ = static_cast<std::size_t>(std::ftell(f));
+      std::fseek(f, 0, SEEK_SET);
+      copy_.resize(size_ / 8 + 1);
+      if (std::fread(copy_.data(), 1, size_, f) == size_)
+        base_ = reinterpret_cast<const unsigned char*>(copy_.data());
+      std::fclose(f);
+    }
+#endif
+    if (!base_ || !valid()) return close(), false;
+    return true;
+  }
+
+  void close() {
+#ifdef SORT_STORE_MMAP
+    if (base_) munmap(const_cast<unsigned char*>(base_), size_);
+#else
+    copy_.clear();
+#endif
+    base_ = nullptr;
+    size_ = 0;
+  }
+
+  explicit operator bool() const { return base_ != nullptr; }
+
+  const store::header& header() const { return *reinterpret_cast<const store::header*>(base_); }
+
+  // Zero copy view of a section, empty if it is missing or of another width
+  template <class X> view<X> get(std::uint32_t kind) const {
+    auto s = find(kind);
+    if (!s || s->width != sizeof(X)) return view<X>();
+    return view<X>{reinterpret_cast<const X*>(base_ + s->offset), static_cast<std::size_t>(s->count)};
+  }
+
+  const section* find(std::uint32_t kind) const {
+    auto s = sections();
+    for (std::uint32_t i = 0; i < header().sections; ++i)
+      if (s[i].kind == kind) return s + i;
+    return nullptr;
+  }
+
+  // Checks the text hash (if given) and the checksum of every section
+  bool verify() const {
+    auto s = sections();
+    for (std::uint32_t i = 0; i < header().sections; ++i) {
+      checksum sum;
+      sum.update(base_ + s[i].offset, s[i].count * s[i].width);
+      if (sum.value() != s[i].checksum) return false;
+    }
+    return true;
+  }
+
+  template <class S> bool verify(S first, S last) const {
+    return header().text == store::hash(first, last) && verify();
+  }
+
+ private:
+  const section* sections() const {
+    return reinterpret_cast<const section*>(base_ + sizeof(store::header));
+  }
+
+  // Every section has to lie within the file, checked without overflowing
+  // (offset + count * width may wrap around on a crafted header)
+  bool valid() const {
+    if (size_ < PAGE) return false;
+    auto& h = header();
+    if (h.magic != MAGIC || h.version != VERSION || h.endian != ENDIAN || h.sections > MAX_SECTIONS)
+      return false;
+    auto s = sections();
+    for (std::uint32_t i = 0; i < h.sections; ++i)
+      if (s[i].offset % PAGE || s[i].width == 0 || s[i].offset > size_
+          || s[i].count > (size_ - s[i].offset) / s[i].width)
+        return false;
+    return true;
+  }
+
+  const unsigned char* base_ = nullptr;
+  std::size_t size_ = 0;
+#ifndef SORT_STORE_MMAP
+  std::vector<std::uint64_t> copy_;
+#endif
+};
+
+}  // store
+}  // sort
+
+#endif  // SORT_STORE_H
@@ -48,6 +48,7 @@
 #include <vector>
 
 #include "detail/suffix.h"
+#include "detail/thread.h"
 #include "inplace.h"
 #include "copy.h"
 
@@ -65,14 +66,19 @@ namespace suffix {
 // moreover the name of each group should equal the position of
 // the beginning in SA (e.g. generated by an EXclusive scan)
 // [Sf Sl) is additional space available
+// emit(first, last) is called on consecutive ranges of SA as soon as they
+// are final (left to right) so SA and ISA of [first, last) may be read
+// while they are still in the cache
 #ifdef USE_COPY
-template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf, V Af, V Al) {
+template <class T, class U, class V, class F> void daware(T SAf, T SAl, U ISAf, V Af, V Al, F emit) {
   using X = std::remove_reference_t<decltype(*ISAf)>;
   using Y = std::remove_reference_t<decltype(*SAf)>;
-  auto* Sf = reinterpret_cast<detail::misc::pair<X, Y>*>(&*Af);
+  // No scratch space at all (e.g. an empty vector) has nothing to dereference
+  auto* Sf = Af != Al ? reinterpret_cast<detail::misc::pair<X, Y>*>(&*Af) : nullptr;
   auto* Sl = Sf + (Al - Af) / sizeof(decltype(*Sf)) * sizeof(decltype(*Af));
+  detail::copy::cache<Y, X> cache;  // shared by all groups
 #else
-template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf) {
+template <class T, class U, class F> void daware(T SAf, T SAl, U ISAf, F emit) {
 #endif
   // This is a "pulling" or "lazy" rather than a "pushing" version of GSACA
   //  while GSACA sorts previous elements using info of the current group
@@ -183,7 +189,7 @@ template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf) {
           // sort all type S
           constexpr auto RL = detail::misc::RL;
 #ifdef USE_COPY
-          sort::copy::quick<RL>(sgf, sgl, Sf, Sl, index, detail::suffix::name(SAf, ISAf, depth));
+          detail::copy::quick<RL>(sgf, sgl, Sf, Sl, index, detail::suffix::name(SAf, ISAf, depth), cache);
 #else
           sort::inplace::quick<RL>(sgf, sgl, index, detail::suffix::name(SAf, ISAf, depth));
 #endif
@@ -195,7 +201,9 @@ template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf) {
   }
 
   // Induce the order of all suffixes from left to right
+  emit(SAf, SAf + 1);  // the sentinel
   for (auto gf = SAf + 1; gf < SAl;) {
+    auto done = gf;
     auto gl = gf;
     while (0 <= *gl++);  // End of the group is flagged
     gl[-1] = ~gl[-1];    // Flip the flag
@@ -207,25 +215,415 @@ template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf) {
     // All elements of the left are already unique so we simply need to sort
     constexpr auto NOCB = detail::misc::NOCB;
 #ifdef USE_COPY
-    sort::copy::quick<NOCB>(gf, gl, Sf, Sl, index);
+    detail::copy::quick<NOCB>(gf, gl, Sf, Sl, index, cache);
 #else
     sort::inplace::quick<NOCB>(gf, gl, index);
 #endif
+    gf = gl;
+    // Scan over all unique groups
+    for (; gf < SAl && *gf < 0; ++gf) *gf = ~*gf;
+
     // And give each of them a unique name
+    // Maybe we could somehow overwrite the embedded depth info in the
+    // sorting stage to make this unnecessary for the unique groups
+#ifdef USE_COPY
+    detail::suffix::scatter(SAf, ISAf, done, gf, std::distance(SAf, SAl), Sf, Sl);
+#else
     auto castToIndex = detail::misc::castTo<decltype(*ISAf)>();
-    std::for_each(gf, gl, [ISAf, SAf, castToIndex](auto &a) { ISAf[a] = castToIndex(&a - &*SAf); });
+    for (auto it = done; it != gf; ++it) ISAf[*it] = castToIndex(it - SAf);
+#endif
+    emit(done, gf);
+  }
 
-    gf = gl;
-    // Scan over all unique groups
-    for (; gf < SAl && *gf < 0; ++gf) {
-      *gf = ~*gf;
-      // Maybe we could somehow overwrite the embedded depth info in the
-      // sorting stage to make this unnecessary
-      ISAf[*gf] = castToIndex(gf - SAf);
+  // Now the SA is completly sorted and ISA is completly reconstructed
+}
+
+#ifdef USE_COPY
+template <class T, class U, class V> void daware(T SAf, T SAl, U ISAf, V Af, V Al) {
+  sort::suffix::daware(SAf, SAl, ISAf, Af, Al, [](T a, T b) { (void) a; (void) b; });
+}
+#else
+template <class T, class U> void daware(T SAf, T SAl, U ISAf) {
+  sort::suffix::daware(SAf, SAl, ISAf, [](T a, T b) { (void) a; (void) b; });
+}
+#endif
+
+// Suffix array of an integer text [Tf, Tl) with symbols in [0, sigma)
+// (e.g. 16/32 bit tokens or DNA read through a proxy iterator)
+// The initial grouping uses direct bucketing for small alphabets and
+// a LSD radix sort for big ones, then the depth aware stages run unchanged.
+// SA and ISA need room for n + 1 elements, SA[0] == n is the sentinel
+#ifdef USE_COPY
+template <class S, class T, class U, class V>
+void build(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf, V Af, V Al) {
+  detail::suffix::group(Tf, Tl, sigma, SAf, ISAf);
+  sort::suffix::daware(SAf, SAf + (std::distance(Tf, Tl) + 1), ISAf, Af, Al);
+}
+#else
+template <class S, class T, class U>
+void build(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf) {
+  detail::suffix::group(Tf, Tl, sigma, SAf, ISAf);
+  sort::suffix::daware(SAf, SAf + (std::distance(Tf, Tl) + 1), ISAf);
+}
+#endif
+
+// Extends the suffix array of [Tf, Tm) to the one of [Tf, Tl) after the
+// chunk [Tm, Tl) was appended to the text. SA and ISA hold the n + 1
+// elements computed by build() for [Tf, Tm) and need room for N + 1.
+// Appending only changes the order of old suffixes which are a prefix of
+// another suffix: these are the last L ones (L = longest repeated suffix).
+// Only [Tm - L, Tl) is sorted with daware, every one of those suffixes is
+// binary searched among the untouched old ones and a linear merge places
+// them. The cost is O((L + m) log n) comparisons plus O(N) for the merge.
+#ifdef USE_COPY
+template <class S, class T, class U, class V>
+void append(S Tf, S Tm, S Tl, std::size_t sigma, T SAf, U ISAf, V Af, V Al) {
+#else
+template <class S, class T, class U>
+void append(S Tf, S Tm, S Tl, std::size_t sigma, T SAf, U ISAf) {
+#endif
+  using X = std::remove_reference_t<decltype(*ISAf)>;
+  auto castToIndex = detail::misc::castTo<decltype(*ISAf)>();
+  auto n = std::distance(Tf, Tm), N = std::distance(Tf, Tl);
+  if (n == N) return;
+
+  // Sort the suffixes whose order may change together with the new ones
+  auto L = detail::suffix::repeated(Tf, n, SAf, ISAf);
+  auto u = N - (n - L);
+  std::vector<X> uSA(u + 1), uISA(u + 1);
+#ifdef USE_COPY
+  sort::suffix::build(Tm - L, Tl, sigma, uSA.begin(), uISA.begin(), Af, Al);
+#else
+  sort::suffix::build(Tm - L, Tl, sigma, uSA.begin(), uISA.begin());
+#endif
+
+  // Keep the old suffixes which stay in place (drops the sentinel too)
+  std::ptrdiff_t s = 0;
+  for (std::ptrdiff_t r = 1; r <= n; ++r)
+    if (SAf[r] < n - L) SAf[1 + s++] = SAf[r];
+
+  // Merge the new ones in
+  for (auto it = uSA.begin() + 1; it != uSA.end(); ++it)
+    *it = castToIndex(*it + (n - L));
+  detail::suffix::insert(Tf, N, SAf + 1, s, uSA.begin() + 1, uSA.end());
+
+  SAf[0] = castToIndex(N);
+  for (std::ptrdiff_t r = 0; r <= N; ++r)
+    ISAf[SAf[r]] = castToIndex(r);
+}
+
+// Sparse suffix array of every k-th suffix of [Tf, Tl) (b = ceil(n / k))
+// The k symbols starting at each sampled position are named by their rank
+// (a suffix truncated by the end of the text being the smallest) and
+// daware sorts the text of these b names. A suffix of the reduced text
+// compares exactly like the sampled suffix so no symbol is compared again.
+// SA and ISA need room for b + 1 elements, on return [SAf, SAf + b) holds
+// the sorted positions and ISA[i] the rank of position i * k.
+// Besides SA and ISA it needs about 6 * b elements at its peak (the cached
+// keys of the naming step) where build() needs 3 * n in total
+template <class S, class T, class U>
+void sparse(S Tf, S Tl, std::size_t k, T SAf, U ISAf) {
+  using X = std::remove_reference_t<decltype(*ISAf)>;
+  auto castToIndex = detail::misc::castTo<decltype(*ISAf)>();
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  auto K = static_cast<std::ptrdiff_t>(k);
+  auto b = (n + K - 1) / K;
+  if (b == 0) return;
+
+  // Name the blocks (starting at 0) in ISA until the sort keys are gone
+  std::ptrdiff_t sigma = -1;
+  {
+    std::vector<unsigned char> head(b);
+    for (std::ptrdiff_t i = 0; i < b; ++i) SAf[i] = castToIndex(i * K);
+    detail::suffix::sparse(Tf, n, SAf, b, K, head.begin());
+    for (std::ptrdiff_t r = 0; r < b; ++r) {
+      sigma += head[r];
+      ISAf[SAf[r] / K] = castToIndex(sigma);
     }
   }
+  std::vector<X> R(ISAf, ISAf + b);
 
-  // Now the SA is completly sorted and ISA is completly reconstructed
+#ifdef USE_COPY
+  std::vector<X> A(b + 1);
+  sort::suffix::build(R.begin(), R.end(), sigma + 1, SAf, ISAf, A.begin(), A.end());
+#else
+  sort::suffix::build(R.begin(), R.end(), sigma + 1, SAf, ISAf);
+#endif
+
+  // Drop the sentinel
+  for (std::ptrdiff_t r = 0; r < b; ++r) {
+    SAf[r] = castToIndex(SAf[r + 1] * K);
+    ISAf[r] = castToIndex(ISAf[r] - 1);
+  }
+}
+
+// Sparse suffix array of an arbitrary set of starting positions
+// [SAf, SAf + b) holds the positions on entry and their suffixes in sorted
+// order on return. Uses the multikey quicksort of the naming step on the
+// whole suffixes so it needs O(b) memory but compares symbols up to the
+// longest common prefix of neighbours (prefer the every k-th version)
+template <class S, class T>
+void sparse(S Tf, S Tl, T SAf, T SAl) {
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  auto b = static_cast<std::ptrdiff_t>(std::distance(SAf, SAl));
+  std::vector<unsigned char> head(b);
+  detail::suffix::sparse(Tf, n, SAf, b, n, head.begin());
+}
+
+// Suffixes of [Tf, Tl) sorted by their first k symbols only, ties are left
+// in any order (e.g. for k-mer seed indexes). [SAf, SAf + n) receives the
+// positions (no sentinel) and head[i] is 1 if the k-mer at SA[i] differs
+// from the one at SA[i - 1] (so every group of equal k-mers starts at a 1),
+// a suffix shorter than k is smaller than its extensions.
+// Multikey sort on the compacted alphabet packed into 64 bit keys which
+// stops at depth k (one round for k <= 21 on DNA) rather than daware: its
+// depths count from the next smaller suffix and type F groups are only
+// ordered by induction from completely sorted ones so a group can't be
+// finished early at an absolute depth. Needs n keys of 64 bit besides SA.
+template <class S, class T, class H>
+void truncated(S Tf, S Tl, std::size_t k, T SAf, H head) {
+  auto castToIndex = detail::misc::castTo<decltype(*SAf)>();
+  auto n = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+  for (std::ptrdiff_t i = 0; i < n; ++i) SAf[i] = castToIndex(i);
+  auto K = static_cast<std::ptrdiff_t>(std::min<std::size_t>(k, static_cast<std::size_t>(n)));
+  detail::suffix::kmers(Tf, n, SAf, K, head);
+}
+
+// Chunk parallel construction: the text is split into one chunk per
+// thread and every chunk is sorted with build() together with the text
+// following it. The order of a chunk is final once none of its suffixes
+// is a prefix of a later one in that window (see append), the window
+// grows until it is. Every suffix then knows its rank in its chunk and
+// every CHUNK_STEP * threads-th one its rank in all chunks: two suffixes
+// of different chunks are compared up to the next such step at most,
+// then by rank. A parallel multiway merge cut at sampled
+// splitters writes SA and a last pass ISA. Same result as build() but
+// needs about 4 * n / threads extra elements per thread (up to the rest
+// of the text for repeats longer than a chunk) and n for the sorted chunks.
+// threads = 0 uses one thread per hardware thread, needs -pthread
+template <class S, class T, class U>
+void parallel(S Tf, S Tl, std::size_t sigma, T SAf, U ISAf, unsigned threads = 0) {
+  using X = std::remove_reference_t<decltype(*ISAf)>;
+  auto castToIndex = detail::misc::castTo<decltype(*ISAf)>();
+  auto N = static_cast<std::ptrdiff_t>(std::distance(Tf, Tl));
+
+  detail::thread::pool pool(threads);
+  std::ptrdiff_t p = pool.size();
+  if (p == 1 || N < p * detail::misc::CHUNK_MIN) {
+#ifdef USE_COPY
+    std::vector<X> A(N + 1);
+    return sort::suffix::build(Tf, Tl, sigma, SAf, ISAf, A.begin(), A.end());
+#else
+    return sort::suffix::build(Tf, Tl, sigma, SAf, ISAf);
+#endif
+  }
+  auto bound = [N, p](std::ptrdiff_t c) { return N * c / p; };
+  auto chunk = [&](std::ptrdiff_t x) {
+    auto c = std::min(p - 1, x * p / N);
+    while (bound(c + 1) <= x) ++c;
+    while (bound(c) > x) --c;
+    return c;
+  };
+
+  // Sort the chunks (in global positions)
+  std::vector<std::vector<X>> lists(p);
+  pool.run(p, [&](unsigned w, std::size_t c) {
+    (void) w;
+    auto s = bound(c), e = bound(c + 1), len = e - s;
+    for (auto m = std::min(N - e, len / 64);;) {
+      auto n = len + m;
+      std::vector<X> SA(n + 1), ISA(n + 1);
+#ifdef USE_COPY
+      std::vector<X> A(n + 1);
+      sort::suffix::build(Tf + s, Tf + (s + n), sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+#else
+      sort::suffix::build(Tf + s, Tf + (s + n), sigma, SA.begin(), ISA.begin());
+#endif
+      auto L = e + m == N ? 0 : detail::suffix::repeated(Tf + s, n, SA.begin(), ISA.begin());
+      if (n - L >= len) {
+        auto &list = lists[c];
+        list.resize(len);
+        std::ptrdiff_t k = 0;
+        for (std::ptrdiff_t r = 1; r <= n; ++r)
+          if (SA[r] < len) list[k++] = castToIndex(SA[r] + s);
+        break;
+      }
+      m = std::min(N - e, std::max(2 * m, 2 * L));
+    }
+  });
+
+  // ISA holds the rank of every suffix in its chunk until the last pass
+  pool.run(p, [&](unsigned w, std::size_t c) {
+    (void) w;
+    auto &list = lists[c];
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(list.size()); ++i)
+      ISAf[list[i]] = castToIndex(i);
+  });
+  auto rank = [&](std::ptrdiff_t x) { return static_cast<std::ptrdiff_t>(ISAf[x]); };
+
+  // Every B-th suffix of a chunk is a step, at[r * p + d] counts the
+  // suffixes of chunk d smaller than step r (steps numbered by position).
+  // Two suffixes of different chunks are compared up to the nearer step,
+  // then the one at a known step is looked up in the chunk of the other.
+  std::ptrdiff_t B = detail::misc::CHUNK_STEP * p;
+  std::vector<std::ptrdiff_t> off(p + 1);
+  for (std::ptrdiff_t c = 0; c < p; ++c)
+    off[c + 1] = off[c] + (bound(c + 1) - bound(c) + B - 1) / B;
+  std::vector<X> at(off[p] * p);
+  auto less = [&](std::ptrdiff_t x, std::ptrdiff_t y, auto known) {
+    for (;;) {
+      if (x == N || y == N) return x == N && y != N;
+      auto c = chunk(x), d = chunk(y);
+      if (c == d) return rank(x) < rank(y);
+      auto i = x - bound(c), k = y - bound(d);
+      if (i % B == 0 && known(off[c] + i / B))
+        return static_cast<std::ptrdiff_t>(at[(off[c] + i / B) * p + d]) <= rank(y);
+      if (k % B == 0 && known(off[d] + k / B))
+        return rank(x) < static_cast<std::ptrdiff_t>(at[(off[d] + k / B) * p + c]);
+      auto t = std::min(std::min(bound(c + 1) - x, B - i % B), std::min(bound(d + 1) - y, B - k % B));
+      auto m = std::mismatch(Tf + x, Tf + (x + t), Tf + y);
+      if (m.first != Tf + (x + t))
+        return detail::suffix::symbol(m.first) < detail::suffix::symbol(m.second);
+      x += t, y += t;
+    }
+  };
+  auto start = [&](std::ptrdiff_t r) { return std::upper_bound(off.begin(), off.end(), r)[-1] == r; };
+  auto locate = [&](std::ptrdiff_t r, std::ptrdiff_t c, std::ptrdiff_t d, auto known) {
+    auto q = bound(c) + (r - off[c]) * B;
+    auto &list = lists[d];
+    at[r * p + d] = castToIndex(c == d ? rank(q) : std::partition_point(list.begin(), list.end(), [&](std::ptrdiff_t z) {
+      return less(z, q, known);
+    }) - list.begin());
+  };
+
+  // Chunk starts from the last one: a comparison reaches a known one
+  // within the chunk it started in. Then the other steps of every chunk
+  // from its last one, these reach a known step within B symbols.
+  for (auto c = p - 1; c >= 0; --c) {
+    pool.run(p, [&](unsigned w, std::size_t d) {
+      (void) w;
+      locate(off[c], c, d, [&](std::ptrdiff_t r) { return r > off[c] && start(r); });
+    });
+  }
+  pool.run(p, [&](unsigned w, std::size_t c) {
+    (void) w;
+    for (auto r = off[c + 1] - 1; r > off[c]; --r)
+      for (std::ptrdiff_t d = 0; d < p; ++d)
+        locate(r, c, d, [&](std::ptrdiff_t s) { return (s > r && s < off[c + 1]) || start(s); });
+  });
+  auto known = [](std::ptrdiff_t) { return true; };
+
+  // p - 1 splitters from an evenly spaced sample of all chunks, the
+  // sample of every chunk is sorted already
+  std::vector<X> sample;
+  for (auto &list : lists) {
+    auto mid = static_cast<std::ptrdiff_t>(sample.size());
+    auto step = std::max<std::ptrdiff_t>(1, list.size() / (8 * p));
+    for (auto i = step / 2; i < static_cast<std::ptrdiff_t>(list.size()); i += step)
+      sample.push_back(list[i]);
+    std::inplace_merge(sample.begin(), sample.begin() + mid, sample.end(), [&](std::ptrdiff_t x, std::ptrdiff_t y) {
+      return less(x, y, known);
+    });
+  }
+
+  // cut[c * (p + 1) + k]: elements of chunk c going to the parts before k
+  std::vector<std::ptrdiff_t> cut(p * (p + 1));
+  pool.run(p, [&](unsigned w, std::size_t c) {
+    (void) w;
+    auto &list = lists[c];
+    cut[c * (p + 1) + p] = list.size();
+    for (std::ptrdiff_t k = 1; k < p; ++k) {
+      auto y = static_cast<std::ptrdiff_t>(sample[k * sample.size() / p]);
+      cut[c * (p + 1) + k] = std::partition_point(list.begin(), list.end(), [&](std::ptrdiff_t x) {
+        return less(x, y, known);
+      }) - list.begin();
+    }
+  });
+
+  // Merge part k of every chunk into SA - the heap holds chunk numbers
+  pool.run(p, [&](unsigned w, std::size_t k) {
+    (void) w;
+    std::ptrdiff_t out = 1;
+    std::vector<std::ptrdiff_t> pos(p), heap;
+    for (std::ptrdiff_t c = 0; c < p; ++c) {
+      out += cut[c * (p + 1) + k];
+      pos[c] = cut[c * (p + 1) + k];
+      if (pos[c] < cut[c * (p + 1) + k + 1]) heap.push_back(c);
+    }
+
+    // Most comparisons are decided by the cached first symbols of the heads
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> key(p);
+    auto load = [&](std::ptrdiff_t c) {
+      auto x = static_cast<std::ptrdiff_t>(lists[c][pos[c]]);
+      key[c] = detail::suffix::prefix(Tf, N, x);
+    };
+    for (auto c : heap) load(c);
+    auto greater = [&](std::ptrdiff_t a, std::ptrdiff_t b) {
+      if (key[a] != key[b]) return key[b] < key[a];
+      return less(lists[b][pos[b]], lists[a][pos[a]], known);
+    };
+    std::make_heap(heap.begin(), heap.end(), greater);
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      auto c = heap.back();
+      SAf[out++] = lists[c][pos[c]++];
+      if (pos[c] < cut[c * (p + 1) + k + 1])
+        load(c), std::push_heap(heap.begin(), heap.end(), greater);
+      else
+        heap.pop_back();
+    }
+  });
+
+  SAf[0] = castToIndex(N);
+  ISAf[N] = castToIndex(0);
+  pool.run(p, [&](unsigned w, std::size_t k) {
+    (void) w;
+    for (auto r = 1 + N * std::ptrdiff_t(k) / p; r < 1 + N * std::ptrdiff_t(k + 1) / p; ++r)
+      ISAf[SAf[r]] = castToIndex(r);
+  });
+}
+
+// Generalized suffix array over a collection of k documents
+// the text is the concatenation [Tf, Tf + D[k]) of the documents
+// [Tf + D[d], Tf + D[d + 1]) given by k + 1 boundaries in [Df, Dl)
+// Each document ends in its own unique sentinel without using up a symbol
+// of the alphabet so no suffix is ever compared across a boundary.
+// Suffixes equal up to their document end are ordered by decreasing document.
+// SA and ISA need room for n + k elements (one sentinel slot per document)
+// on return [SAf, SAf + n) is the suffix array, ISA its inverse and
+// DA[i] the document of suffix SA[i]
+#ifdef USE_COPY
+template <class S, class B, class T, class U, class W, class V>
+void generalized(S Tf, B Df, B Dl, T SAf, U ISAf, W DAf, V Af, V Al) {
+#else
+template <class S, class B, class T, class U, class W>
+void generalized(S Tf, B Df, B Dl, T SAf, U ISAf, W DAf) {
+#endif
+  auto k = std::distance(Df, Dl) - 1;
+  auto n = static_cast<std::ptrdiff_t>(Df[k]);
+  if (k < 1) return;
+
+  // Sort the virtual text where document d starts at D[d] + d
+  detail::suffix::documents(Tf, Df, Dl, SAf, ISAf);
+#ifdef USE_COPY
+  sort::suffix::daware(SAf, SAf + (n + k), ISAf, Af, Al);
+#else
+  sort::suffix::daware(SAf, SAf + (n + k), ISAf);
+#endif
+
+  // The k sentinels occupy the first k ranks. Map the virtual positions back
+  // and fill the document array in the same pass. Reading ISA at p = i + d
+  // while writing ISA at i is safe because p never falls behind i.
+  auto castToIndex = detail::misc::castTo<decltype(*ISAf)>();
+  auto castToDoc = detail::misc::castTo<decltype(*DAf)>();
+  for (decltype(k) d = 0; d < k; ++d) {
+    for (auto i = static_cast<std::ptrdiff_t>(Df[d]); i < static_cast<std::ptrdiff_t>(Df[d + 1]); ++i) {
+      auto r = ISAf[i + d] - k;
+      SAf[r] = castToIndex(i);
+      DAf[r] = castToDoc(d);
+      ISAf[i] = castToIndex(r);
+    }
+  }
 }
 
 }  // suffix
@@ -0,0 +1,66 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Append test
+//  grows texts of the shapes of naive::text chunk by chunk with
+//  sort::suffix::append and compares SA and ISA after every chunk with a
+//  naive suffix array. Periodic texts make most old suffixes a prefix of
+//  a later one, single symbol chunks and chunks of up to 200 alternate.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 200 && ok; ++it) {
+    std::size_t N = rng() % 700 + 1, sigma = rng() % 4 + 1;
+    auto t = naive::text(rng, N, sigma, it % 3);
+
+    std::vector<std::int32_t> SA(N + 1), ISA(N + 1), A(N + 1);
+    std::size_t n = rng() % N + 1;
+    sort::suffix::build(t.begin(), t.begin() + n, sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+    while (n < N) {
+      auto m = std::min<std::size_t>(N, n + rng() % (it % 2 ? 8 : 200) + 1);
+      sort::suffix::append(t.begin(), t.begin() + n, t.begin() + m, sigma, SA.begin(), ISA.begin(),
+                           A.begin(), A.end());
+      n = m;
+
+      auto ref = naive::suffixes(std::vector<int>(t.begin(), t.begin() + n)), inv = naive::inverse(ref);
+      if (!std::equal(ref.begin(), ref.end(), SA.begin()) || !std::equal(inv.begin(), inv.end(), ISA.begin())) {
+        std::printf("append FAILED (input %d, length %zu)\n", it, n);
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
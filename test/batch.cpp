@@ -0,0 +1,74 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Block BWT test
+//  transforms batches of blocks of mixed sizes (empty ones, single bytes,
+//  all equal bytes and the shapes of naive::text) with sort::batch::engine
+//  on 1 to 4 threads and compares output and primary row of every block
+//  with the BWT taken from a naive suffix array. Engines are reused for
+//  several batches so the per thread buffers are grown and shrunk into.
+//  Needs -pthread.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../batch.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (unsigned threads = 1; threads <= 4; ++threads) {
+    sort::batch::engine<> e(threads);
+    for (int round = 0; round < 6; ++round) {
+      std::vector<std::vector<unsigned char>> in(rng() % 40 + 1), out(in.size());
+      std::vector<sort::batch::block> blocks(in.size());
+      for (std::size_t b = 0; b < in.size(); ++b) {
+        std::size_t n = rng() % 4 == 0 ? rng() % 3 : rng() % (round % 2 ? 3000 : 300);
+        in[b] = naive::text<unsigned char>(rng, n, rng() % 2 ? 256 : rng() % 4 + 1, static_cast<int>(b % 3));
+        out[b].assign(n, 0);
+        blocks[b] = sort::batch::block{in[b].data(), out[b].data(), n, ~std::size_t(0)};
+      }
+      e.bwt(blocks);
+
+      for (std::size_t b = 0; b < in.size(); ++b) {
+        auto SA = naive::suffixes(in[b]);
+        std::vector<unsigned char> ref;
+        std::size_t primary = 0;
+        for (std::size_t r = 0; r < SA.size(); ++r) {
+          if (SA[r] == 0) primary = r;
+          else ref.push_back(in[b][SA[r] - 1]);
+        }
+        if (out[b] != ref || blocks[b].primary != primary) {
+          std::printf("bwt FAILED (%u threads, block %zu of %zu bytes)\n", threads, b, in[b].size());
+          ok = false;
+        }
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
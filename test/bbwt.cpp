@@ -0,0 +1,100 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Bijective BWT test
+//  sort::lyndon::bbwt against its definition: the Lyndon factors of the
+//  text by Duval's algorithm, all conjugates of all factors sorted by
+//  their infinite repetitions and the last symbol of each. Besides the
+//  shapes of naive::text there are unary texts, texts that are a single
+//  Lyndon word and texts of many equal factors.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../lyndon.h"
+#include "naive.h"
+
+// Lengths of the Lyndon factors of t (Duval)
+static std::vector<std::size_t> factors(const std::vector<int> &t) {
+  std::vector<std::size_t> f;
+  for (std::size_t i = 0, n = t.size(); i < n;) {
+    auto j = i + 1, k = i;
+    for (; j < n && t[k] <= t[j]; ++j) k = t[k] < t[j] ? i : k + 1;
+    for (; i <= k; i += j - k) f.push_back(j - k);
+  }
+  return f;
+}
+
+static std::vector<int> bbwt(const std::vector<int> &t) {
+  std::vector<std::vector<int>> c;
+  std::size_t s = 0;
+  for (auto l : factors(t)) {
+    for (std::size_t r = 0; r < l; ++r) {
+      c.emplace_back(t.begin() + (s + r), t.begin() + (s + l));
+      c.back().insert(c.back().end(), t.begin() + s, t.begin() + (s + r));
+    }
+    s += l;
+  }
+  // u^w < v^w decides within the first |u| + |v| symbols
+  std::stable_sort(c.begin(), c.end(), [](const std::vector<int> &u, const std::vector<int> &v) {
+    for (std::size_t i = 0; i < u.size() + v.size(); ++i)
+      if (u[i % u.size()] != v[i % v.size()]) return u[i % u.size()] < v[i % v.size()];
+    return false;
+  });
+  std::vector<int> o;
+  for (auto &w : c) o.push_back(w.back());
+  return o;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 1000; ++it) {
+    std::size_t n = rng() % (it % 4 ? 60 : 1500) + 1, sigma = rng() % 4 + 2;
+    auto t = naive::text(rng, n, sigma, it % 3);
+    if (it % 5 == 1) {  // unary
+      t.assign(n, static_cast<int>(rng() % sigma));
+    } else if (it % 5 == 2) {  // a single factor, the smallest symbol only once
+      t[0] = 0;
+      for (std::size_t i = 1; i < n; ++i) t[i] = static_cast<int>(rng() % (sigma - 1)) + 1;
+    } else if (it % 5 == 3) {  // many copies of one factor, maybe followed by smaller ones
+      std::vector<int> w(rng() % 5 + 1);
+      for (auto &c : w) c = static_cast<int>(rng() % (sigma - 1)) + 1;
+      w[0] = 0;
+      for (std::size_t i = 0; i < n; ++i) t[i] = w[i % w.size()];
+    }
+
+    std::vector<int> o(n);
+    sort::lyndon::bbwt(t.begin(), t.end(), o.begin());
+    if (o != bbwt(t)) {
+      std::printf("lyndon::bbwt FAILED (input %d, n %zu, %zu factors)\n", it, n, factors(t).size());
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Budget test
+//  sort::budget::build following plans of sort::budget::make without
+//  scratch space (in-place), with a few thousand elements (groups bigger
+//  than that sort in chunks) and with n + 1 elements compared with
+//  sort::suffix::build on texts of the shapes of naive::text. The limit
+//  must hold the predicted peak and a plan that doesn't fit builds
+//  nothing. Build with -fsanitize=address,undefined to catch scratch
+//  accesses out of range.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../budget.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 60; ++it) {
+    std::size_t n = it % 3 ? rng() % 5000 + 1 : rng() % 300000 + 400000, sigma = rng() % 4 + 1;
+    auto t = naive::text(rng, n, sigma, it % 3);
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1), rSA(n + 1), rISA(n + 1);
+    sort::suffix::build(t.begin(), t.end(), sigma, rSA.begin(), rISA.begin(), A.begin(), A.end());
+
+    auto base = 2 * (n + 1) * sizeof(std::int32_t) + sort::budget::grouping(n, sigma);
+    // None, a few thousand elements besides the chunking buffers (n + 1 for short texts) and plenty
+    std::size_t few = sort::budget::chunking() + (2 * sort::detail::misc::COPY_MIN + rng() % 4096) * 4;
+    for (std::size_t extra : {std::size_t(0), few, n * 8 + (1 << 20)}) {
+      auto p = sort::budget::make(n, base + extra, sigma);
+      std::fill(SA.begin(), SA.end(), 0);
+      bool good = p.fits() && p.peak <= base + extra && (extra != 0 || !p.copy())
+        && sort::budget::build(t.begin(), t.end(), sigma, SA.begin(), ISA.begin(), p)
+        && SA == rSA && ISA == rISA;
+      if (!good) {
+        std::printf("budget FAILED (input %d, n %zu, scratch %zu)\n", it, n, p.scratch);
+        ok = false;
+      }
+    }
+
+    auto p = sort::budget::make(n, base - 1, sigma);
+    SA[0] = -1;
+    if (p.fits() || p.peak != base || sort::budget::build(t.begin(), t.end(), sigma, SA.begin(), ISA.begin(), p)
+        || SA[0] != -1) {
+      std::printf("budget FAILED (input %d, n %zu, limit below the minimum)\n", it, n);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
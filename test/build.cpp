@@ -0,0 +1,71 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Integer alphabet test
+//  sort::suffix::build on texts of 8, 16, 32 and 64 bit symbols against a
+//  naive suffix array. Small alphabets go through direct bucketing, big
+//  ones through the LSD radix sort with an even and an odd number of
+//  passes (2 to 6 of RADIX_BITS), signed chars have to sort as unsigned.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+// sigma 0 stands for the whole 64 bit range
+template <class W, class R> bool check(R &rng, std::size_t sigma, int runs) {
+  bool ok = true;
+  for (int it = 0; it < runs; ++it) {
+    std::size_t n = rng() % 2000;
+    // Few distinct symbols spread over the whole alphabet
+    auto t = naive::text<W>(rng, n, rng() % 30 + 1, it % 3);
+    std::vector<W> map(30);
+    for (auto &m : map) m = static_cast<W>(sigma ? rng() % sigma : rng());
+    for (auto &c : t) c = map[static_cast<std::size_t>(c)];
+
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1);
+    sort::suffix::build(t.begin(), t.end(), sigma ? sigma : ~std::size_t(0), SA.begin(), ISA.begin(), A.begin(), A.end());
+    if (SA != naive::suffixes(t) || ISA != naive::inverse(SA)) {
+      std::printf("build FAILED (%zu byte symbols, sigma %zu, n %zu)\n", sizeof(W), sigma, n);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+  ok &= check<unsigned char>(rng, 256, 100);
+  ok &= check<signed char>(rng, 256, 100);
+  ok &= check<std::uint16_t>(rng, 65536, 100);
+  // Radix sort with 2, 3, 4 and 6 passes
+  ok &= check<std::uint32_t>(rng, 70000, 100);
+  ok &= check<std::uint32_t>(rng, 1 << 23, 100);
+  ok &= check<std::uint64_t>(rng, std::size_t(1) << 34, 100);
+  ok &= check<std::uint64_t>(rng, 0, 100);
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
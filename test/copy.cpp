@@ -0,0 +1,105 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Copy quicksort test
+//  sort::copy::quick on positions whose 32 bit keys (negative ones like
+//  the -depth marks of daware included) are looked up elsewhere and on
+//  64 bit elements sorting by themselves, with scratch space of n + 1
+//  elements, n + 1 starting off the 8 byte alignment, and too small
+//  (n / 2, n / 8 and n / 16). Small scratch sorts the groups in chunks
+//  (many, few and two distinct keys). Checks the order, that the
+//  elements are a permutation and the callbacks in LR and RL order.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../copy.h"
+#include "naive.h"
+
+// The scratch lives in words so that skew can move it 4 bytes off
+// the 8 byte alignment (only pairs of 32 bit values allow that)
+template <int LR, class W, class I> bool check(const std::vector<W> &v, I index, std::ptrdiff_t s, bool skew) {
+  using K = decltype(index(v[0]));
+  using P = sort::pair<K, W>;
+  std::vector<std::uint64_t> raw((s + 1) * sizeof(P) / 8 + 1);
+  auto Sf = reinterpret_cast<P *>(reinterpret_cast<char *>(raw.data()) + (skew ? 4 : 0));
+  std::uninitialized_fill_n(Sf, s, P());
+  auto a = v;
+  naive::calls c;
+  auto cb = [&](auto f, auto l) { c.emplace_back(f - a.begin(), l - a.begin()); };
+  sort::copy::quick<LR>(a.begin(), a.end(), Sf, Sf + s, index, cb);
+  auto b = v;
+  sort::copy::quick<LR>(b.begin(), b.end(), Sf, Sf + s, index);
+
+  std::vector<K> keys(a.size()), ref(v.size());
+  std::transform(a.begin(), a.end(), keys.begin(), index);
+  std::transform(v.begin(), v.end(), ref.begin(), index);
+  std::sort(ref.begin(), ref.end());
+  auto x = a, y = v;
+  std::sort(x.begin(), x.end());
+  std::sort(y.begin(), y.end());
+  std::transform(b.begin(), b.end(), a.begin(), index);  // keys of the version without callbacks
+  bool good = keys == ref && x == y && naive::ranges(c, ref, LR == 1);
+  good &= std::equal(ref.begin(), ref.end(), a.begin());
+  std::sort(b.begin(), b.end());
+  good &= b == y;
+  return good;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 40; ++it) {
+    auto n = static_cast<std::ptrdiff_t>(it % 8 ? rng() % 5000 + 1000 : rng() % 100000 + 140000);
+    std::int64_t m = it % 4 == 0 ? 2 : it % 4 == 1 ? 50 : n;
+    std::vector<std::int32_t> key(n);
+    std::vector<std::uint32_t> pos(n);
+    std::vector<std::int64_t> wide(n);
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      key[i] = static_cast<std::int32_t>(rng() % m) - static_cast<std::int32_t>(m / 2);
+      pos[i] = static_cast<std::uint32_t>(i);
+      wide[i] = static_cast<std::int64_t>(rng() % m) - static_cast<std::int64_t>(m) * 1000000000;
+    }
+    std::shuffle(pos.begin(), pos.end(), rng);
+    auto byKey = [&key](std::uint32_t i) { return key[i]; };
+    auto self = [](std::int64_t x) { return x; };
+
+    for (int k = 0; k < 5; ++k) {
+      auto s = k < 2 ? n + 1 : n / (k == 2 ? 2 : k == 3 ? 8 : 16);
+      bool skew = k == 1;
+      bool good = check<1>(pos, byKey, s, skew) && check<0>(pos, byKey, s, skew) &&
+                  check<1>(wide, self, s, false) && check<0>(wide, self, s, false);
+      if (!good) {
+        std::printf("copy::quick FAILED (input %d, n %td, scratch %td%s)\n", it, n, s, skew ? " misaligned" : "");
+        ok = false;
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Worst case fallback test
+//  runs detail::inplace::quick with its budget exhausted from the start so
+//  everything goes through the fallback: the heap sort without scratch
+//  space and the merge sort with scratch of several sizes (down to less
+//  than one run of insertion sort). Checks the order against std::sort of
+//  the keys, that the elements are a permutation and the equal range
+//  callbacks in both directions.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../inplace.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 200; ++it) {
+    int n = static_cast<int>(rng() % (it % 20 == 0 ? 100000 : 3000)) + 1;
+    std::uint64_t m = it % 3 == 0 ? 5 : it % 3 == 1 ? n / 2 + 1 : ~0ull;
+    std::vector<std::uint32_t> key(n);
+    for (auto &k : key) k = static_cast<std::uint32_t>(rng() % m);
+    std::vector<int> v(n);
+    for (int i = 0; i < n; ++i) v[i] = i;
+    if (it % 5 != 4) std::shuffle(v.begin(), v.end(), rng);
+    auto index = [&key](int i) { return key[i]; };
+
+    auto ref = key;
+    std::sort(ref.begin(), ref.end());
+    auto check = [&](const std::vector<int> &a, const naive::calls &c, bool LR, const char *name) {
+      bool good = naive::ranges(c, ref, LR);
+      for (int i = 0; i < n; ++i) good &= key[a[i]] == ref[i];
+      auto b = a;
+      std::sort(b.begin(), b.end());
+      for (int i = 0; i < n; ++i) good &= b[i] == i;
+      if (!good) std::printf("%s FAILED (input %d, n %d)\n", name, it, n);
+      ok &= good;
+    };
+
+    // Without scratch space (heap sort) and with scratch of n, n / 7,
+    // n / 300 and one element (merge sort)
+    for (int dir = 0; dir < 2; ++dir) {
+      auto run = [&](int d, auto... S) {
+        auto a = v;
+        naive::calls c;
+        auto cb = [&](auto f, auto l) { c.emplace_back(f - a.begin(), l - a.begin()); };
+        if (dir) sort::detail::inplace::quick<1, 0>(a.begin(), a.end(), index, cb, 0, S...);
+        else sort::detail::inplace::quick<0, 0>(a.begin(), a.end(), index, cb, 0, S...);
+        check(a, c, dir, d ? "fallback merge" : "fallback heap");
+      };
+      run(0);
+      for (int d : {1, 7, 300, 1 << 30}) {
+        std::vector<sort::detail::misc::pair<std::uint32_t, int>> S(std::max(n / d, 1));
+        run(d, S.data(), S.data() + S.size());
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// FM-index test
+//  builds sort::fm::index with sampling rates from 1 to 100 over byte
+//  texts that contain 0 (the symbol of the placeholder in the BWT) and
+//  checks locate() of every row against a naive suffix array, find() and
+//  count() of substrings, random patterns and ones longer than the text
+//  against a scan, and extract() of random ranges (also cut by the end).
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../fm.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 150; ++it) {
+    std::size_t n = rng() % 2000, sigma = it % 4 ? rng() % 4 + 1 : 256, rate = it % 5 ? rng() % 100 + 1 : 1;
+    auto t = naive::text<unsigned char>(rng, n, sigma, it % 3);
+    sort::fm::index<> fm(t.begin(), t.end(), rate);
+    auto SA = naive::suffixes(t);
+    bool good = fm.size() == n && fm.rate() == rate;
+
+    for (std::size_t r = 0; r <= n; ++r) good &= fm.locate(r) == static_cast<std::size_t>(SA[r]);
+
+    for (int q = 0; q < 100; ++q) {
+      std::vector<unsigned char> p;
+      std::size_t m = rng() % 10, s = n ? rng() % n : 0;
+      if (q % 2) p.assign(t.begin() + s, t.begin() + std::min(n, s + m));
+      else for (std::size_t j = 0; j < m; ++j) p.push_back(static_cast<unsigned char>(rng() % (sigma + 1)));
+      if (q == 0) p.assign(t.begin(), t.end()), p.push_back(0);
+
+      // Rows of the suffixes starting with p are consecutive in SA
+      std::size_t lo = 0, hi;
+      auto match = [&](std::size_t r) {
+        return n - SA[r] >= p.size() && std::equal(p.begin(), p.end(), t.begin() + SA[r]);
+      };
+      while (lo <= n && !match(lo)) ++lo;
+      for (hi = lo; hi <= n && match(hi);) ++hi;
+      auto rows = fm.find(p.begin(), p.end());
+      good &= rows.second - rows.first == hi - lo && (lo == hi || rows.first == lo);
+      good &= fm.count(p.begin(), p.end()) == hi - lo;
+
+      std::size_t pos = rng() % (n + 2), len = rng() % 50;
+      std::vector<unsigned char> out(len, 1);
+      auto end = fm.extract(pos, len, out.begin());
+      auto a = std::min(pos, n), b = std::min(n, pos + len);
+      good &= end - out.begin() == static_cast<std::ptrdiff_t>(b - a) && std::equal(t.begin() + a, t.begin() + b, out.begin());
+    }
+    if (!good) {
+      std::printf("fm FAILED (input %d, n %zu, rate %zu)\n", it, n, rate);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Generalized suffix array test
+//  builds sort::suffix::generalized over collections of 1 to 30 documents
+//  (empty ones, duplicates and documents that are prefixes of others) and
+//  compares SA, ISA and DA with a naive sort of all (document, position)
+//  pairs: suffixes compare within their document, running out first is
+//  smaller and equal ones are ordered by decreasing document.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 500; ++it) {
+    std::size_t k = rng() % (it % 10 ? 8 : 30) + 1, sigma = rng() % 4 + 1;
+    std::vector<unsigned char> t;
+    std::vector<std::int64_t> D{0};
+    for (std::size_t d = 0; d < k; ++d) {
+      std::size_t len = rng() % 5 == 0 ? 0 : rng() % 200 + 1;
+      auto doc = naive::text<unsigned char>(rng, len, sigma, static_cast<int>(rng() % 3));
+      if (d > 0 && rng() % 4 == 0) {  // copy or prefix of the previous document
+        doc.assign(t.begin() + D[d - 1], t.end());
+        doc.resize(rng() % 2 ? doc.size() : doc.size() / 2);
+      }
+      t.insert(t.end(), doc.begin(), doc.end());
+      D.push_back(static_cast<std::int64_t>(t.size()));
+    }
+    std::size_t n = t.size();
+
+    // Naive: sort the positions by (suffix in its document, -document)
+    std::vector<std::int32_t> doc(n), ref(n);
+    for (std::size_t d = 0; d < k; ++d)
+      for (auto i = D[d]; i < D[d + 1]; ++i) doc[i] = static_cast<std::int32_t>(d);
+    for (std::size_t i = 0; i < n; ++i) ref[i] = static_cast<std::int32_t>(i);
+    std::sort(ref.begin(), ref.end(), [&](std::int32_t a, std::int32_t b) {
+      auto ea = t.begin() + D[doc[a] + 1], eb = t.begin() + D[doc[b] + 1];
+      auto m = std::mismatch(t.begin() + a, ea, t.begin() + b, eb);
+      if (m.first != ea && m.second != eb) return *m.first < *m.second;
+      if (m.first == ea && m.second == eb) return doc[a] > doc[b];
+      return m.first == ea;
+    });
+
+    std::vector<std::int32_t> SA(n + k), ISA(n + k), DA(n), A(n + k);
+    sort::suffix::generalized(t.begin(), D.begin(), D.end(), SA.begin(), ISA.begin(), DA.begin(), A.begin(), A.end());
+    bool good = std::equal(ref.begin(), ref.end(), SA.begin());
+    for (std::size_t r = 0; r < n; ++r)
+      good &= ISA[ref[r]] == static_cast<std::int32_t>(r) && DA[r] == doc[ref[r]];
+    if (!good) {
+      std::printf("generalized FAILED (input %d, %zu documents, n %zu)\n", it, k, n);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Key/value sort test
+//  sort::sort_by_key on arithmetic keys (unsigned, negative and floating
+//  point ones, which take the block partitioner) and on strings (the
+//  three pivot quicksort) with a column of positions as values. The keys
+//  have to come out like std::sort, every value next to its own key and
+//  the callbacks cover the equal ranges in LR or RL order.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../key.h"
+#include "naive.h"
+
+template <int LR, class K> bool check(const std::vector<K> &keys, const char *name) {
+  auto ref = keys;
+  std::sort(ref.begin(), ref.end());
+
+  auto k = keys;
+  std::vector<std::int32_t> v(k.size());
+  for (std::size_t i = 0; i < v.size(); ++i) v[i] = static_cast<std::int32_t>(i);
+  naive::calls c;
+  sort::sort_by_key<LR>(k.begin(), k.end(), v.begin(), [&](auto a, auto b) {
+    c.emplace_back(a - k.begin(), b - k.begin());
+  });
+  bool good = k == ref && naive::ranges(c, ref, LR == sort::detail::misc::LR);
+  for (std::size_t i = 0; i < v.size(); ++i) good &= keys[v[i]] == k[i];
+
+  auto plain = keys;
+  sort::sort_by_key<LR>(plain.begin(), plain.end());
+  good &= plain == ref;
+  if (!good) std::printf("%s FAILED (%s, n %zu)\n", name, LR ? "LR" : "RL", keys.size());
+  return good;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 200; ++it) {
+    std::size_t n = rng() % (it % 10 ? 2000 : 100000), m = it % 2 ? 10 : n + 1;
+    std::vector<std::uint32_t> u(n);
+    std::vector<std::int64_t> s(n);
+    std::vector<double> d(n);
+    std::vector<std::string> w(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      u[i] = static_cast<std::uint32_t>(rng() % m);
+      s[i] = static_cast<std::int64_t>(rng() % m) - static_cast<std::int64_t>(m / 2);
+      d[i] = static_cast<double>(s[i]) / 4;
+      w[i] = std::string(rng() % 3, 'x') + std::to_string(rng() % m);
+    }
+    ok &= check<1>(u, "unsigned") && check<0>(u, "unsigned");
+    ok &= check<1>(s, "signed") && check<0>(s, "signed");
+    ok &= check<1>(d, "double") && check<0>(d, "double");
+    if (n <= 2000) ok &= check<1>(w, "string") && check<0>(w, "string");
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
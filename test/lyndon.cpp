@@ -0,0 +1,80 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Lyndon array test
+//  sort::lyndon::array from a naive ISA and from a text against the next
+//  smaller value of the ISA on texts of the shapes of naive::text, binary
+//  and unary ones included. Short texts are also checked against the
+//  longest prefix of every suffix that is a Lyndon word.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../lyndon.h"
+#include "naive.h"
+
+// A word is a Lyndon word if it is smaller than all its proper suffixes
+static bool lyndonWord(const std::vector<int> &t, std::size_t f, std::size_t l) {
+  for (auto i = f + 1; i < l; ++i)
+    if (!std::lexicographical_compare(t.begin() + f, t.begin() + l, t.begin() + i, t.begin() + l)) return false;
+  return true;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 600; ++it) {
+    std::size_t n = rng() % (it % 2 ? 50 : 1500) + 1, sigma = it % 10 ? rng() % 4 + 1 : 1;
+    auto t = naive::text(rng, n, sigma, it % 3);
+    auto ISA = naive::inverse(naive::suffixes(t));
+
+    // Next smaller value, ISA[n] == 0 ends every chain
+    std::vector<std::int32_t> ref(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto j = i + 1;
+      while (ISA[j] > ISA[i]) ++j;
+      ref[i] = static_cast<std::int32_t>(j - i);
+    }
+    std::vector<std::int32_t> L(n), M(n);
+    sort::lyndon::array(ISA.begin(), static_cast<std::ptrdiff_t>(n), L.begin());
+    sort::lyndon::array(t.begin(), t.end(), sigma, M.begin());
+    bool good = L == ref && M == ref;
+
+    if (n <= 50)
+      for (std::size_t i = 0; i < n; ++i) {
+        auto l = n - i;
+        while (!lyndonWord(t, i, i + l)) --l;
+        good &= static_cast<std::size_t>(ref[i]) == l;
+      }
+    if (!good) {
+      std::printf("lyndon::array FAILED (input %d, n %zu, sigma %zu)\n", it, n, sigma);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
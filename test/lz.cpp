@@ -0,0 +1,90 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// LZ77 test
+//  checks the greedy parse of sort::lz::factorize against a brute force
+//  search for the longest previous factor (possibly overlapping) at every
+//  factor start: factors tile the text, every source really occurs before
+//  and a new symbol is only reported the first time it appears. Runs the
+//  version building the suffix array and the one given SA and ISA with
+//  scratch too small for the NSV on texts of the shapes of naive::text.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../lz.h"
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 1000; ++it) {
+    std::ptrdiff_t n = static_cast<std::ptrdiff_t>(rng() % 600) + 1;
+    std::size_t sigma = rng() % (it % 4 ? 4 : 30) + 1;
+    auto t = naive::text(rng, static_cast<std::size_t>(n), sigma, it % 3);
+
+    auto check = [&](const std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> &f, const char *name) {
+      bool good = true;
+      std::ptrdiff_t i = 0;
+      for (auto x : f) {
+        if (i >= n) { good = false; break; }
+        std::ptrdiff_t best = 0;
+        for (std::ptrdiff_t p = 0; p < i; ++p) {
+          std::ptrdiff_t l = 0;
+          while (i + l < n && t[p + l] == t[i + l]) ++l;
+          best = std::max(best, l);
+        }
+        if (x.second == 0) {
+          good &= best == 0 && x.first == t[i];
+          ++i;
+          continue;
+        }
+        good &= x.second == best && 0 <= x.first && x.first < i;
+        for (std::ptrdiff_t l = 0; good && l < x.second; ++l) good &= t[x.first + l] == t[i + l];
+        i += x.second;
+      }
+      good &= i == n;
+      if (!good) std::printf("%s FAILED (input %d, n %td)\n", name, it, n);
+      ok &= good;
+    };
+
+    std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> f;
+    auto out = [&f](std::ptrdiff_t a, std::ptrdiff_t b) { f.emplace_back(a, b); };
+    sort::lz::factorize(t.begin(), t.end(), sigma, out);
+    check(f, "factorize");
+
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1);
+    sort::suffix::build(t.begin(), t.end(), sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+    f.clear();
+    sort::lz::factorize(t.begin(), t.end(), SA.begin(), ISA.begin(), A.begin(), A.begin() + n / 2, out);
+    check(f, "factorize (small scratch)");
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
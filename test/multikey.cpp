@@ -0,0 +1,75 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Multikey quicksort test
+//  checks the order and the LCP array of sort::strings::multikey against
+//  std::sort and a naive LCP on random strings of small alphabets (long
+//  common prefixes across the 8 character words), empty strings and
+//  many duplicates, through get_char and as null terminated strings.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../multikey.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 400; ++it) {
+    std::size_t n = rng() % 3000 + 1, len = rng() % 40 + 1, sigma = rng() % 4 + 1;
+    std::string prefix(rng() % 20, 'p');
+    std::vector<std::string> v(n);
+    for (auto &s : v) {
+      s = it % 2 ? prefix : "";
+      for (std::size_t l = rng() % (len + 1); l > 0; --l) s += static_cast<char>('a' + rng() % sigma);
+    }
+    for (std::size_t i = 0; i < n / 4; ++i) v[rng() % n] = v[rng() % n];
+
+    auto s = v;
+    std::sort(s.begin(), s.end());
+    std::vector<std::ptrdiff_t> ref(n);
+    for (std::size_t i = 1; i < n; ++i)
+      ref[i] = std::mismatch(s[i - 1].begin(), s[i - 1].end(), s[i].begin(), s[i].end()).first - s[i - 1].begin();
+
+    auto a = v;
+    auto lcp = sort::strings::multikey(a.begin(), a.end(), [](const std::string &x, std::ptrdiff_t d) {
+      return d < static_cast<std::ptrdiff_t>(x.size()) ? static_cast<unsigned char>(x[d]) : 0;
+    });
+    std::vector<const char *> c(n);
+    for (std::size_t i = 0; i < n; ++i) c[i] = v[i].c_str();
+    auto lcpc = sort::strings::multikey(c.begin(), c.end());
+    bool same = lcpc == ref;
+    for (std::size_t i = 0; i < n; ++i) same &= s[i] == c[i];
+
+    if (a != s || lcp != ref || !same) {
+      std::printf("multikey FAILED (input %d, n %zu)\n", it, n);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
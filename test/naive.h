@@ -0,0 +1,98 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Naive references
+//  slow but obviously correct versions of what the library computes,
+//  shared by the programs in test/ (quadratic or worse, keep inputs small)
+
+#ifndef SORT_TEST_NAIVE_H
+#define SORT_TEST_NAIVE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace naive {
+
+// Random text of n symbols in [0, sigma) shaped to stress suffix sorting:
+// 0 uniform, 1 periodic (period up to 7) and 2 mostly a repeat of the
+// text a third before (long but not endless common prefixes)
+template <class W = int, class R>
+std::vector<W> text(R &rng, std::size_t n, std::size_t sigma, int shape) {
+  std::vector<W> t(n);
+  for (auto &c : t) c = static_cast<W>(rng() % sigma);
+  if (shape == 1)
+    for (std::size_t i = rng() % 7 + 1, p = i; i < n; ++i) t[i] = t[i % p];
+  if (shape == 2)
+    for (std::size_t i = n / 3; i < n; ++i)
+      if (rng() % 50) t[i] = t[i - n / 3];
+  return t;
+}
+
+// Suffix order of a text, a suffix running out is smaller than its
+// extensions (compared as unsigned like detail::suffix::symbol)
+template <class W> bool less(const std::vector<W> &t, std::size_t a, std::size_t b) {
+  return std::lexicographical_compare(t.begin() + a, t.end(), t.begin() + b, t.end(), [](W x, W y) {
+    return static_cast<std::uint64_t>(x) < static_cast<std::uint64_t>(y);
+  });
+}
+
+// Suffix array as computed by sort::suffix::build: n + 1 rows, the
+// sentinel (empty suffix at n) first
+template <class W> std::vector<std::int32_t> suffixes(const std::vector<W> &t) {
+  std::vector<std::int32_t> SA(t.size() + 1);
+  for (std::size_t i = 0; i < SA.size(); ++i) SA[i] = static_cast<std::int32_t>(i);
+  std::sort(SA.begin(), SA.end(), [&t](std::int32_t a, std::int32_t b) { return less(t, a, b); });
+  return SA;
+}
+
+// Rank of every suffix
+inline std::vector<std::int32_t> inverse(const std::vector<std::int32_t> &SA) {
+  std::vector<std::int32_t> ISA(SA.size());
+  for (std::size_t r = 0; r < SA.size(); ++r) ISA[SA[r]] = static_cast<std::int32_t>(r);
+  return ISA;
+}
+
+// Equal range callbacks of a sort as offsets [first, second) from the
+// start, in the order they were called
+using calls = std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>>;
+
+// Holds if the callbacks c covered the sorted keys once, left to right
+// (LR) or right to left, each of them a maximal range of equal keys
+template <class K> bool ranges(const calls &c, const std::vector<K> &keys, bool LR) {
+  auto n = static_cast<std::ptrdiff_t>(keys.size()), next = LR ? 0 : n;
+  for (auto r : c) {
+    if (r.first >= r.second || (LR ? r.first : r.second) != next) return false;
+    next = LR ? r.second : r.first;
+    for (auto i = r.first + 1; i < r.second; ++i)
+      if (keys[i] != keys[r.first]) return false;
+    if ((r.first > 0 && keys[r.first - 1] == keys[r.first]) || (r.second < n && keys[r.second] == keys[r.first]))
+      return false;
+  }
+  return next == (LR ? n : 0);
+}
+
+}  // naive
+
+#endif  // SORT_TEST_NAIVE_H
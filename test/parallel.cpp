@@ -0,0 +1,74 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Parallel suffix array test
+//  compares SA and ISA of sort::suffix::parallel on 1 to 5 threads with
+//  sort::suffix::build. Chunks are only cut above CHUNK_MIN symbols per
+//  thread so the texts are a few million symbols: random ones, periodic
+//  ones (abcabc... and longer periods, every chunk boundary falls into a
+//  repeat reaching the end of the text), mostly repeated ones and one
+//  with a long run of one symbol. Tiny texts (fewer symbols than threads)
+//  take the single threaded path. Needs -pthread.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+  auto check = [&](const std::vector<unsigned char> &t, std::size_t sigma, unsigned threads, const char *name) {
+    auto n = t.size();
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1), SB(n + 1), ISB(n + 1);
+    sort::suffix::build(t.begin(), t.end(), sigma, SA.begin(), ISA.begin(), A.begin(), A.end());
+    sort::suffix::parallel(t.begin(), t.end(), sigma, SB.begin(), ISB.begin(), threads);
+    if (SA != SB || ISA != ISB) {
+      std::printf("parallel FAILED (%s, n %zu, %u threads)\n", name, n, threads);
+      ok = false;
+    }
+  };
+
+  for (unsigned threads = 1; threads <= 5; ++threads)
+    for (std::size_t n = 0; n < 7; ++n) check(naive::text<unsigned char>(rng, n, 2, 0), 2, threads, "tiny");
+
+  std::size_t chunk = sort::detail::misc::CHUNK_MIN;
+  for (unsigned threads = 2; threads <= 5; ++threads) {
+    std::size_t n = threads * chunk + rng() % 1000;
+    auto t = naive::text<unsigned char>(rng, n, threads % 2 ? 4 : 256, 0);
+    check(t, 256, threads, "random");
+    if (threads == 4) continue;
+    for (std::size_t i = 0; i < n; ++i) t[i] = static_cast<unsigned char>('a' + i % 3);
+    check(t, 256, threads, "abc");
+  }
+  check(naive::text<unsigned char>(rng, 3 * chunk + 17, 3, 1), 3, 3, "periodic");
+  check(naive::text<unsigned char>(rng, 2 * chunk + 5, 4, 2), 4, 2, "repeated");
+  auto t = naive::text<unsigned char>(rng, 4 * chunk, 4, 0);
+  std::fill(t.begin() + chunk / 2, t.begin() + 3 * chunk, 1);
+  check(t, 4, 4, "run");
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
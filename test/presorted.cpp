@@ -0,0 +1,78 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Presorted input test
+//  sort::inplace::quick and block on ascending, descending, nearly sorted
+//  (a few swaps, more than PARTIAL_MAX moves apart), sorted with a random
+//  tail and organ pipe inputs, with and without duplicates. These take
+//  the presorted shortcut or give it up halfway and still have to come
+//  out sorted with the equal range callbacks in LR and RL order.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../inplace.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  auto index = [](std::int64_t x) { return x; };
+  bool ok = true;
+
+  for (int it = 0; it < 3000; ++it) {
+    auto n = static_cast<std::ptrdiff_t>(rng() % (it % 50 ? 2000 : 200000));
+    std::int64_t m = it % 2 ? 1 : 3;  // duplicates
+    std::vector<std::int64_t> v(n);
+    for (std::ptrdiff_t i = 0; i < n; ++i) v[i] = i / m;
+    int shape = it % 6;
+    if (shape == 1) std::reverse(v.begin(), v.end());
+    if (shape == 2 || shape == 3)  // nearly sorted, a few or some swaps
+      for (auto s = rng() % (shape == 2 ? 3 : 30); n > 1 && s > 0; --s)
+        std::swap(v[rng() % n], v[rng() % n]);
+    if (shape == 4)  // random tail
+      for (auto i = n - n / 8; i < n; ++i) v[i] = static_cast<std::int64_t>(rng() % (n + 1));
+    if (shape == 5)  // organ pipe
+      std::reverse(v.begin() + n / 2, v.end());
+    auto ref = v;
+    std::sort(ref.begin(), ref.end());
+
+    for (int k = 0; k < 4; ++k) {
+      auto a = v;
+      naive::calls c;
+      auto cb = [&](auto f, auto l) { c.emplace_back(f - a.begin(), l - a.begin()); };
+      if (k == 0) sort::inplace::quick<1>(a.begin(), a.end(), index, cb);
+      if (k == 1) sort::inplace::quick<0>(a.begin(), a.end(), index, cb);
+      if (k == 2) sort::inplace::block<1>(a.begin(), a.end(), index, cb);
+      if (k == 3) sort::inplace::block<0>(a.begin(), a.end(), index, cb);
+      if (a != ref || !naive::ranges(c, ref, k % 2 == 0)) {
+        std::printf("%s FAILED (shape %d, n %td, %s)\n", k < 2 ? "quick" : "block", shape, n, k % 2 ? "RL" : "LR");
+        ok = false;
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Query engine test
+//  counts and locates patterns (substrings of the text, random ones, ones
+//  with symbols out of the text and ones longer than it) with
+//  sort::query::engine on the n + 1 rows of build() and on the n suffixes
+//  only, one by one and in batches on several threads, and compares them
+//  with the occurences found by scanning texts of the shapes of
+//  naive::text. Needs -pthread.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../query.h"
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 200; ++it) {
+    std::size_t n = rng() % 5000 + 1, sigma = rng() % (it % 4 ? 4 : 40) + 1;
+    auto t = naive::text<unsigned char>(rng, n, sigma, it % 3);
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1);
+    sort::suffix::build(t.begin(), t.end(), 256, SA.begin(), ISA.begin(), A.begin(), A.end());
+
+    std::vector<std::vector<unsigned char>> P(rng() % 200 + 1);
+    for (auto &p : P) {
+      std::size_t m = rng() % 12 + 1, s = rng() % n;
+      if (rng() % 2) p.assign(t.begin() + s, t.begin() + std::min(n, s + m));
+      else for (std::size_t j = 0; j < m; ++j) p.push_back(static_cast<unsigned char>(rng() % (sigma + 1)));
+      if (rng() % 50 == 0) p.assign(t.begin(), t.end()), p.push_back(0);
+    }
+
+    // Occurences by scanning, sorted by position
+    std::vector<std::vector<std::int32_t>> ref(P.size());
+    for (std::size_t i = 0; i < P.size(); ++i)
+      for (std::size_t s = 0; s + P[i].size() <= n; ++s)
+        if (std::equal(P[i].begin(), P[i].end(), t.begin() + s)) ref[i].push_back(static_cast<std::int32_t>(s));
+
+    for (int rows = 0; rows < 2; ++rows) {
+      const std::int32_t *Sf = SA.data() + rows, *Sl = SA.data() + SA.size();
+      sort::query::engine<const unsigned char *, const std::int32_t *> e(t.data(), t.data() + n, Sf, Sl,
+                                                                        rng() % 3 + 1, 3);
+      std::vector<std::size_t> counts(P.size()), bounds(P.size() + 1);
+      std::vector<std::int32_t> out(n * P.size() + 1);
+      e.count(P.begin(), P.end(), counts.begin());
+      auto total = e.locate(P.begin(), P.end(), bounds.begin(), out.begin());
+
+      bool good = total == bounds[P.size()];
+      for (std::size_t i = 0; i < P.size(); ++i) {
+        std::vector<std::int32_t> found(out.begin() + bounds[i], out.begin() + bounds[i + 1]);
+        std::sort(found.begin(), found.end());
+        good &= found == ref[i] && counts[i] == ref[i].size();
+        good &= e.count(P[i].begin(), P[i].end()) == ref[i].size();
+      }
+      if (!good) std::printf("query FAILED (input %d, %s)\n", it, rows ? "n rows" : "n + 1 rows");
+      ok &= good;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Runs test
+//  compares sort::lyndon::runs with a brute force search of all maximal
+//  repetitions on texts of the shapes of naive::text, Thue-Morse,
+//  Fibonacci and a^k b a^k c texts (every run exactly once), and the
+//  longest common extensions of detail::lyndon::lce with a naive scan on
+//  periodic texts whose long extensions spend its budget and build the
+//  LCP table.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "../lyndon.h"
+#include "naive.h"
+
+using run = std::tuple<long, long, long>;  // start, length, period
+
+// Runs of t: for every period p the maximal ranges with t[i] == t[i + p]
+// spanning 2 * p, kept if no smaller period covers them
+static std::set<run> brute(const std::vector<int> &t) {
+  long n = static_cast<long>(t.size());
+  std::set<run> out;
+  for (long p = 1; 2 * p <= n; ++p)
+    for (long a = 0; a + p < n;) {
+      long b = a;
+      while (b + p < n && t[b] == t[b + p]) ++b;
+      if (b - a >= p) {
+        long q = 1;
+        for (; q < p; ++q) {
+          long x = a;
+          while (x + q < b + p && t[x] == t[x + q]) ++x;
+          if (x + q == b + p) break;
+        }
+        if (q == p) out.insert(run(a, b + p - a, p));
+      }
+      a = b + 1;
+    }
+  return out;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 3000; ++it) {
+    long n = static_cast<long>(rng() % (it % 100 == 0 ? 3000 : 200)) + 1;
+    std::size_t sigma = rng() % 4 + 1;
+    auto t = naive::text(rng, n, sigma, it % 3);
+    if (it % 5 == 1) {  // Thue-Morse, the parity of the bits of i
+      sigma = 2;
+      t[0] = 0;
+      for (long i = 1; i < n; ++i) t[i] = t[i / 2] ^ (i & 1);
+    }
+    if (it % 5 == 2) {  // Fibonacci
+      sigma = 2;
+      std::vector<int> a{0}, b{0, 1};
+      while (static_cast<long>(b.size()) < n) {
+        auto c = b;
+        c.insert(c.end(), a.begin(), a.end());
+        a = b, b = c;
+      }
+      t.assign(b.begin(), b.begin() + n);
+    }
+    if (it % 5 == 3) {  // a^k b a^k c
+      sigma = 3;
+      t.assign(n, 0);
+      t[n / 2] = 1, t[n - 1] = 2;
+    }
+
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1);
+    std::set<run> got;
+    int twice = 0;
+    sort::lyndon::runs(t.begin(), t.end(), sigma, SA.begin(), ISA.begin(), A.begin(), A.end(),
+                       [&](auto s, auto l, auto p) { twice += !got.insert(run(s, l, p)).second; });
+    if (got != brute(t) || twice) {
+      std::printf("runs FAILED (input %d, n %ld)\n", it, n);
+      ok = false;
+    }
+  }
+
+  for (int it = 0; it < 50; ++it) {
+    long n = static_cast<long>(rng() % 5000) + 2, p = static_cast<long>(rng() % 40) + 1;
+    std::vector<int> t(n);
+    for (long i = 0; i < n; ++i) t[i] = i < p || rng() % 500 == 0 ? static_cast<int>(rng() % 3) : t[i - p];
+    std::vector<std::int32_t> SA(n + 1), ISA(n + 1), A(n + 1);
+    sort::suffix::build(t.begin(), t.end(), 3, SA.begin(), ISA.begin(), A.begin(), A.end());
+    sort::detail::lyndon::lce<std::vector<int>::iterator, std::vector<std::int32_t>::iterator> lce(t.begin(), n, ISA.begin());
+    for (int q = 0; q < 20000; ++q) {
+      long a = static_cast<long>(rng() % n), b = (a + p * static_cast<long>(rng() % 4 + 1)) % n, l = 0;
+      while (a + l < n && b + l < n && t[a + l] == t[b + l]) ++l;
+      long cap = q % 2 ? static_cast<long>(rng() % 100) : n;
+      if (lce(a, b, cap) != std::min(l, cap)) {
+        std::printf("lce FAILED (input %d, %ld %ld)\n", it, a, b);
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
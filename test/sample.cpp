@@ -0,0 +1,91 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Samplesort test
+//  sort::inplace::sample in both directions and parallel_sample against
+//  std::sort on keys with few, some and many distinct values, sorted and
+//  reversed, up to a few distribution levels deep. Then sort::copy::quick
+//  on a copy big enough for its samplesort (SAMPLE_COPY_MIN) with keys
+//  looked up elsewhere like the groups of daware. Needs -pthread.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../copy.h"
+#include "../inplace.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  auto index = [](std::uint32_t x) { return x; };
+  bool ok = true;
+
+  for (int it = 0; it < 48; ++it) {
+    std::size_t n = rng() % (it % 4 == 0 ? 1000000 : 200000) + 1;
+    std::uint64_t m = it % 3 == 0 ? 7 : it % 3 == 1 ? 1000 : ~0ull;
+    std::vector<std::uint32_t> v(n);
+    for (auto &x : v) x = static_cast<std::uint32_t>(rng() % m);
+    if (it % 8 == 5) std::sort(v.begin(), v.end());
+    if (it % 8 == 7) std::sort(v.rbegin(), v.rend());
+    auto s = v;
+    std::sort(s.begin(), s.end());
+
+    auto a = v;
+    naive::calls c;
+    auto cb = [&](auto f, auto l) { c.emplace_back(f - a.begin(), l - a.begin()); };
+    if (it % 2) sort::inplace::sample<1>(a.begin(), a.end(), index, cb);
+    else sort::inplace::sample<0>(a.begin(), a.end(), index, cb);
+    if (a != s || !naive::ranges(c, s, it % 2)) std::printf("sample FAILED (input %d, n %zu)\n", it, n);
+    ok &= a == s && naive::ranges(c, s, it % 2);
+
+    auto b = v;
+    sort::inplace::parallel_sample(b.begin(), b.end(), index, it % 4 + 1);
+    if (b != s) std::printf("parallel_sample FAILED (input %d, n %zu)\n", it, n);
+    ok &= b == s;
+  }
+
+  // Indirect keys like the groups of daware, above SAMPLE_COPY_MIN copies
+  std::size_t n = (1 << 22) + 12345;
+  std::vector<std::uint32_t> key(n), c(n);
+  for (auto &k : key) k = static_cast<std::uint32_t>(rng() % (n / 3));
+  for (std::size_t i = 0; i < n; ++i) c[i] = static_cast<std::uint32_t>(i);
+  auto byKey = [&key](std::uint32_t i) { return key[i]; };
+  std::vector<sort::pair<std::uint32_t, std::uint32_t>> S(n + 1);
+  naive::calls calls;
+  sort::copy::quick(c.begin(), c.end(), S.begin(), S.end(), byKey, [&](auto f, auto l) {
+    calls.emplace_back(f - c.begin(), l - c.begin());
+  });
+  std::vector<std::uint32_t> keys(n);
+  for (std::size_t i = 0; i < n; ++i) keys[i] = key[c[i]];
+  auto d = c;
+  std::sort(d.begin(), d.end());
+  bool sorted = std::is_sorted(keys.begin(), keys.end()) && naive::ranges(calls, keys, true);
+  for (std::size_t i = 0; i < n; ++i) sorted &= d[i] == i;
+  if (!sorted) std::printf("copy::quick FAILED (n %zu)\n", n);
+  ok &= sorted;
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
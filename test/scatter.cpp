@@ -0,0 +1,66 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Rank scatter test
+//  sort::detail::suffix::scatter on random permutations with ranges of
+//  [first, last) below and above SCATTER_MIN, at the start, inside and
+//  at the end of the SA, with scratch space big enough and too small.
+//  Checks ISA[SA[i]] = i inside the range and untouched entries outside.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../detail/suffix.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+  const std::ptrdiff_t MIN = sort::detail::misc::SCATTER_MIN;
+
+  // The first SA has more regions than SCATTER_BUCKETS
+  for (int it = 0; it < 30; ++it) {
+    std::ptrdiff_t n = static_cast<std::ptrdiff_t>(it ? rng() % (8 * MIN) + MIN : rng() % (1 << 20) + (1 << 24));
+    std::vector<std::int32_t> SA(n), ISA(n, -1);
+    std::iota(SA.begin(), SA.end(), 0);
+    std::shuffle(SA.begin(), SA.end(), rng);
+
+    std::ptrdiff_t m = it % 5 ? static_cast<std::ptrdiff_t>(rng() % (n - MIN / 2)) + MIN / 2 : n;
+    std::ptrdiff_t f = it % 3 == 0 ? 0 : it % 3 == 1 ? n - m : static_cast<std::ptrdiff_t>(rng() % (n - m + 1));
+    std::vector<sort::pair<std::int32_t, std::int32_t>> S(it % 7 == 6 ? m - 1 : m + rng() % 100);
+    sort::detail::suffix::scatter(SA.begin(), ISA.begin(), SA.begin() + f, SA.begin() + (f + m), n, S.begin(), S.end());
+
+    std::vector<std::int32_t> ref(n, -1);
+    for (auto i = f; i < f + m; ++i)
+      ref[SA[i]] = static_cast<std::int32_t>(i);
+    if (ISA != ref) {
+      std::printf("scatter FAILED (n %td, range [%td, %td), scratch %zu)\n", n, f, f + m, S.size());
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
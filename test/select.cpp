@@ -0,0 +1,89 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Selection test
+//  sort::inplace::select (the nth element with no greater one before and
+//  no smaller one after it), partial_sort (a sorted prefix with the
+//  callbacks of its equal ranges) and top_k for every k from below 0 to
+//  above n (clamped) on random, few valued, sorted and reversed keys.
+//  Everything has to stay a permutation of the input.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../inplace.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+  auto index = [](std::int64_t x) { return x; };
+
+  for (int it = 0; it < 2000; ++it) {
+    auto n = static_cast<std::ptrdiff_t>(rng() % (it % 20 ? 300 : 50000));
+    std::uint64_t m = it % 3 ? n + 1 : 4;
+    std::vector<std::int64_t> v(n);
+    for (auto &x : v) x = static_cast<std::int64_t>(rng() % m) - 2;
+    if (it % 7 == 5) std::sort(v.begin(), v.end());
+    if (it % 7 == 6) std::sort(v.rbegin(), v.rend());
+    auto ref = v;
+    std::sort(ref.begin(), ref.end());
+    auto same = [&ref](std::vector<std::int64_t> a) { std::sort(a.begin(), a.end()); return a == ref; };
+
+    // k outside of [0, n] only for top_k
+    auto k = static_cast<std::ptrdiff_t>(rng() % (n + 3)) - 1;
+    auto c = std::max<std::ptrdiff_t>(0, std::min(k, n));
+    bool good = true;
+
+    if (c < n) {
+      auto a = v;
+      sort::inplace::select(a.begin(), a.begin() + c, a.end(), index);
+      good &= same(a) && a[c] == ref[c];
+      for (std::ptrdiff_t i = 0; i < n; ++i) good &= i < c ? a[i] <= a[c] : a[c] <= a[i];
+    }
+
+    auto b = v;
+    naive::calls calls;
+    sort::inplace::partial_sort(b.begin(), b.begin() + c, b.end(), index, [&](auto f, auto l) {
+      calls.emplace_back(f - b.begin(), l - b.begin());
+    });
+    std::vector<std::int64_t> prefix(ref.begin(), ref.begin() + c);
+    good &= same(b) && std::equal(prefix.begin(), prefix.end(), b.begin()) && naive::ranges(calls, prefix, true);
+
+    auto d = v;
+    auto mid = sort::inplace::top_k(d.begin(), d.end(), k, index);
+    good &= mid == d.begin() + c && same(d);
+    std::sort(d.begin(), mid);
+    good &= std::equal(prefix.begin(), prefix.end(), d.begin());
+
+    if (!good) {
+      std::printf("select FAILED (input %d, n %td, k %td)\n", it, n, k);
+      ok = false;
+    }
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+// Sparse suffix array test
+//  checks both versions of sort::suffix::sparse, every k-th suffix (SA and
+//  ISA) and an arbitrary set of positions, against std::sort of the
+//  sampled suffixes with naive::less on the shapes of naive::text.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 600; ++it) {
+    std::size_t n = rng() % 3000 + 1, sigma = rng() % 4 + 1;
+    auto t = naive::text(rng, n, sigma, it % 3);
+    auto less = [&t](std::int32_t a, std::int32_t b) { return naive::less(t, a, b); };
+
+    // Every k-th suffix
+    std::size_t k = rng() % 12 + 1, b = (n + k - 1) / k;
+    std::vector<std::int32_t> ref(b);
+    for (std::size_t i = 0; i < b; ++i) ref[i] = static_cast<std::int32_t>(i * k);
+    std::sort(ref.begin(), ref.end(), less);
+    std::vector<std::int32_t> SA(b + 1), ISA(b + 1);
+    sort::suffix::sparse(t.begin(), t.end(), k, SA.begin(), ISA.begin());
+    bool good = std::equal(ref.begin(), ref.end(), SA.begin());
+    for (std::size_t r = 0; r < b; ++r) good &= ISA[ref[r] / k] == static_cast<std::int32_t>(r);
+    if (!good) std::printf("sparse every k-th FAILED (input %d, n %zu, k %zu)\n", it, n, k);
+    ok &= good;
+
+    // Arbitrary positions
+    std::vector<std::int32_t> P;
+    for (std::size_t i = 0; i < n; ++i)
+      if (rng() % 5 == 0) P.push_back(static_cast<std::int32_t>(i));
+    std::shuffle(P.begin(), P.end(), rng);
+    auto Q = P;
+    std::sort(Q.begin(), Q.end(), less);
+    sort::suffix::sparse(t.begin(), t.end(), P.begin(), P.end());
+    if (P != Q) std::printf("sparse set FAILED (input %d, n %zu)\n", it, n);
+    ok &= P == Q;
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
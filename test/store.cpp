@@ -0,0 +1,179 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// On-disk format test
+//  writes SA, ISA, LCP and BWT of random texts with sort::store::writer
+//  at every element width that fits them (1, 2, 4 and 8 bytes), in pieces
+//  of random size, and reads them back through sort::store::reader.
+//  verify() has to catch a flipped byte in every section, the writer
+//  calls out of order (sections nested or not begun) and open() has to
+//  reject crafted section tables (offsets out of the file, counts whose
+//  byte size overflows). Writes store.tmp in the current directory.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../store.h"
+#include "naive.h"
+
+static const char *path = "store.tmp";
+
+// Section table entry i of the file at path, changed by f
+template <class F> static void patch(std::uint32_t i, F f) {
+  auto file = std::fopen(path, "r+b");
+  sort::store::section s;
+  long at = static_cast<long>(sizeof(sort::store::header) + i * sizeof(s));
+  std::fseek(file, at, SEEK_SET);
+  if (std::fread(&s, sizeof(s), 1, file) == 1) {
+    f(s);
+    std::fseek(file, at, SEEK_SET);
+    std::fwrite(&s, sizeof(s), 1, file);
+  }
+  std::fclose(file);
+}
+
+template <class X, class R> static bool roundtrip(R &rng, std::size_t n) {
+  auto t = naive::text<unsigned char>(rng, n, rng() % 4 + 1, 0);
+  auto SA = naive::suffixes(t), ISA = naive::inverse(SA);
+  std::vector<std::int32_t> LCP(n + 1);
+  std::vector<unsigned char> BWT(n + 1);
+  for (std::size_t r = 1; r <= n; ++r)
+    while (SA[r - 1] + LCP[r] < static_cast<std::int32_t>(n) && SA[r] + LCP[r] < static_cast<std::int32_t>(n)
+           && t[SA[r - 1] + LCP[r]] == t[SA[r] + LCP[r]]) ++LCP[r];
+  for (std::size_t r = 0; r <= n; ++r) BWT[r] = SA[r] ? t[SA[r] - 1] : 0;
+
+  bool good = true;
+  {
+    sort::store::writer w(path, n, sort::store::hash(t.begin(), t.end()), sizeof(X));
+    auto put = [&](std::uint32_t kind, std::uint32_t width, const auto &v) {
+      good &= w.begin(kind, width);
+      for (std::size_t i = 0; i < v.size();) {
+        auto j = std::min(v.size(), i + rng() % 3000 + 1);
+        good &= w.write(v.begin() + i, v.begin() + j);
+        i = j;
+      }
+      good &= w.end();
+    };
+    put(sort::store::SA, sizeof(X), SA);
+    put(sort::store::ISA, sizeof(X), ISA);
+    put(sort::store::LCP, sizeof(X), LCP);
+    put(sort::store::BWT, 1, BWT);
+    good &= w.close();
+  }
+
+  sort::store::reader r(path);
+  good &= static_cast<bool>(r) && r.header().n == n && r.verify(t.begin(), t.end());
+  auto sa = r.get<X>(sort::store::SA), isa = r.get<X>(sort::store::ISA), lcp = r.get<X>(sort::store::LCP);
+  auto bwt = r.get<unsigned char>(sort::store::BWT);
+  good &= sa.size == n + 1 && isa.size == n + 1 && lcp.size == n + 1 && bwt.size == n + 1;
+  good &= !r.get<std::uint16_t>(sort::store::BWT);  // of another width
+  for (std::size_t i = 0; good && i <= n; ++i)
+    good &= sa[i] == static_cast<X>(SA[i]) && isa[i] == static_cast<X>(ISA[i]) && lcp[i] == static_cast<X>(LCP[i])
+         && bwt[i] == BWT[i];
+  r.close();
+
+  // A flipped byte in any section
+  for (std::uint32_t k = sort::store::SA; k <= sort::store::BWT; ++k) {
+    std::uint64_t offset = 0;
+    patch(k - 1, [&offset](sort::store::section &s) { offset = s.offset; });
+    auto file = std::fopen(path, "r+b");
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    int c = std::fgetc(file);
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    std::fputc(c ^ 0x10, file);
+    std::fclose(file);
+    good &= r.open(path) && !r.verify();
+    r.close();
+    file = std::fopen(path, "r+b");
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    std::fputc(c, file);
+    std::fclose(file);
+  }
+  if (!good) std::printf("store FAILED (width %zu, n %zu)\n", sizeof(X), n);
+  return good;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 20; ++it) {
+    ok &= roundtrip<std::uint8_t>(rng, rng() % 255);
+    ok &= roundtrip<std::uint16_t>(rng, rng() % 3000);
+    ok &= roundtrip<std::uint32_t>(rng, rng() % 3000);
+    ok &= roundtrip<std::uint64_t>(rng, rng() % 3000);
+  }
+
+  // Values that don't fit the width
+  {
+    std::vector<std::uint32_t> v{1, 2, 300};
+    sort::store::writer w(path, 3, 0, 4);
+    ok &= w.begin(sort::store::SA, 1) && !w.write(v.begin(), v.end()) && !w.close();
+  }
+
+  // Calls out of order, every one spoils the writer
+  {
+    std::vector<std::uint32_t> v{1, 2, 3};
+    sort::store::writer a(path, 3, 0, 4);
+    ok &= !a.write(v.begin(), v.end()) && !a.begin(sort::store::SA, 4);
+    sort::store::writer b(path, 3, 0, 4);
+    ok &= !b.end() && !b.close();
+    sort::store::writer c(path, 3, 0, 4);
+    ok &= c.begin(sort::store::SA, 4) && !c.begin(sort::store::ISA, 4) && !c.end();
+    sort::store::writer d(path, 3, 0, 4);
+    ok &= d.begin(sort::store::SA, 4) && d.write(v.begin(), v.end()) && !d.close();
+    sort::store::writer e(path, 3, 0, 4);
+    ok &= e.begin(sort::store::SA, 4) && e.write(v.begin(), v.end()) && e.end() && !e.end() && !e.close();
+  }
+
+  // Crafted section tables: sizes that overflow, offsets out of the file
+  // or off the page and elements without width
+  {
+    std::vector<std::uint64_t> v(1000, 7);
+    sort::store::writer w(path, 999, 0, 8);
+    ok &= w.begin(sort::store::SA, 8) && w.write(v.begin(), v.end()) && w.end() && w.close();
+  }
+  sort::store::reader r;
+  ok &= r.open(path);
+  r.close();
+  std::vector<void (*)(sort::store::section &)> craft{
+    [](sort::store::section &s) { s.count = (std::uint64_t(1) << 61) + 1; },  // 8 bytes after wrapping
+    [](sort::store::section &s) { s.count = ~std::uint64_t(0); },
+    [](sort::store::section &s) { s.offset = std::uint64_t(1) << 40; },
+    [](sort::store::section &s) { s.offset = ~std::uint64_t(0) / sort::store::PAGE * sort::store::PAGE; },
+    [](sort::store::section &s) { s.offset += 8; },
+    [](sort::store::section &s) { s.width = 0; },
+  };
+  for (std::size_t i = 0; i < craft.size(); ++i) {
+    sort::store::section keep{};
+    patch(0, [&](sort::store::section &s) { keep = s; craft[i](s); });
+    if (r.open(path)) std::printf("open FAILED (crafted table %zu)\n", i), ok = false;
+    patch(0, [&](sort::store::section &s) { s = keep; });
+  }
+
+  std::remove(path);
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
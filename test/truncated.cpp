@@ -0,0 +1,75 @@
+// Copyright (c) 2016 Christoph Diegelmann
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+
+// Truncated suffix array test
+//  sort::suffix::truncated on texts of the shapes of naive::text over
+//  small and large alphabets with k from 1 to beyond n, several 64 bit
+//  keys deep. Checks that SA is a permutation ordered by the first k
+//  symbols of every suffix and that head marks each new k-mer.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../suffix.h"
+#include "naive.h"
+
+// First k symbols of the suffixes a and b compared, shorter is smaller
+template <class W> static bool less(const std::vector<W> &t, std::size_t k, std::size_t a, std::size_t b) {
+  auto ea = t.begin() + std::min(t.size(), a + k), eb = t.begin() + std::min(t.size(), b + k);
+  return std::lexicographical_compare(t.begin() + a, ea, t.begin() + b, eb);
+}
+
+template <class W, class R> static bool check(R &rng, std::size_t n, std::size_t sigma, int shape) {
+  auto t = naive::text<W>(rng, n, sigma, shape);
+  std::size_t k = rng() % 3 ? rng() % 40 + 1 : rng() % (n + 10) + 1;
+  std::vector<std::int32_t> SA(n);
+  std::vector<unsigned char> head(n);
+  sort::suffix::truncated(t.begin(), t.end(), k, SA.begin(), head.begin());
+
+  auto sorted = SA;
+  std::sort(sorted.begin(), sorted.end());
+  bool good = true;
+  for (std::size_t i = 0; i < n; ++i) {
+    good &= sorted[i] == static_cast<std::int32_t>(i);
+    if (i > 0) good &= !less(t, k, SA[i], SA[i - 1]) && head[i] == less(t, k, SA[i - 1], SA[i]);
+  }
+  good &= n == 0 || head[0] == 1;
+  if (!good) std::printf("suffix::truncated FAILED (n %zu, sigma %zu, k %zu)\n", n, sigma, k);
+  return good;
+}
+
+int main() {
+  std::mt19937_64 rng;
+  bool ok = true;
+
+  for (int it = 0; it < 600; ++it) {
+    std::size_t n = rng() % (it % 2 ? 50 : 5000), sigma = rng() % 4 + 1;
+    ok &= check<unsigned char>(rng, n, it % 5 ? sigma : 256, it % 3);
+    ok &= check<int>(rng, n, it % 5 ? sigma : 100000, it % 3);
+  }
+
+  std::printf(ok ? "ok\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}